@@ -117,6 +117,10 @@ SOURCE=.\cccc_itm.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\cccc_mdf.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\cccc_mem.h
 # End Source File
 # Begin Source File
@@ -141,6 +145,22 @@ SOURCE=.\cccc_rec.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\cccc_src.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\cccc_cch.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\cccc_qry.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\cccc_sym.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\cccc_tbl.h
 # End Source File
 # Begin Source File
@@ -205,6 +225,22 @@ SOURCE=.\cccc_rec.cc
 # End Source File
 # Begin Source File
 
+SOURCE=.\cccc_src.cc
+# End Source File
+# Begin Source File
+
+SOURCE=.\cccc_cch.cc
+# End Source File
+# Begin Source File
+
+SOURCE=.\cccc_qry.cc
+# End Source File
+# Begin Source File
+
+SOURCE=.\cccc_sym.cc
+# End Source File
+# Begin Source File
+
 SOURCE=.\cccc_tbl.cc
 # End Source File
 # Begin Source File
@@ -42,7 +42,9 @@
   // that we can supply the names of dialects (ansi_c, ansi_c++, mfc_c++ etc)
   // for contexts where we wish to apply dialect-specific lexing or parsing
   // rules
-  extern string parse_language;
+  // As files may be parsed on more than one thread at once, each thread
+  // has its own copy.
+  extern thread_local string parse_language;
 >>
 
 #lexaction
@@ -381,6 +383,39 @@ inline void endOfLine(CLexer &lexer)
 // to cause problems
 #tokclass RESYNCHRONISATION { "\}" ";" }
 
+<<
+// A fragment may end after a semicolon or closing brace at the outer
+// level, so long as the next token is also at the outer level and on a
+// later line.  We don't split after a brace which may be followed by 
+// a declarator (as in 'struct S { ... } s;').
+bool CParser::isFragmentBoundary(ANTLRToken *tok, ANTLRToken *next_tok)
+{
+  bool retval=false;
+  if(
+     tok->getNestingLevel()==0 && next_tok->getNestingLevel()==0 &&
+     next_tok->getLine()>tok->getLine() &&
+     next_tok->getType()!=Eof
+     )
+    {
+      switch(tok->getType())
+	{
+	case SEMICOLON:
+	  retval=true;
+	  break;
+	case RBRACE:
+	  retval=
+	    next_tok->getType()!=SEMICOLON &&
+	    next_tok->getType()!=IDENTIFIER &&
+	    next_tok->getType()!=ASTERISK;
+	  break;
+	default:
+	  ;
+	}
+    }
+  return retval;
+}
+>>
+
 class CParser {
 
 <<
@@ -426,6 +461,13 @@ string d1,d2,d3;
 
 public:
 
+// Large files may be lexed in full and then parsed in fragments on
+// several threads.  These functions allow the driver to find the 
+// places where it is safe to split the file between fragments, and 
+// the end of the file, without needing to know the token types.
+static bool isFragmentBoundary(ANTLRToken *tok, ANTLRToken *next_tok);
+static bool isEndOfFile(ANTLRToken *tok) { return tok->getType()==1; }
+
 void init(const string& filename, const string& language)
 {
 	pu=ParseUtility::currentInstance();
@@ -457,7 +499,7 @@ link_item[string& scope] :
 
 end_of_file : eof:Eof
 <<
-  ps->record_other_extent(1,$eof->getLine(),"<file scope items>");
+  ps->record_file_scope_extent($eof->getLine());
 >>
         ;
 
@@ -494,7 +536,7 @@ definition_or_declaration[string& scope] :
   int resync_nesting=mytoken(initial_token)->getNestingLevel();
   pu->resynchronize(resync_nesting,RESYNCHRONISATION_set,resync_token);
 
-  cerr << "Syntax error: parser failed to handle "
+  pu->error_stream() << "Syntax error: parser failed to handle "
        << initial_text << "..." << resync_token->getText()
 	<< " on lines " << initial_token->getLine()
 	<< " to " << resync_token->getLine() << endl;
@@ -952,7 +994,7 @@ knr_param_decl_list :
         | instance_declaration[d1] knr_param_decl_list
 	;
 <<
-        cerr << "failed knr_param_decl_list for token "
+        pu->error_stream() << "failed knr_param_decl_list for token "
              << static_cast<int>(LT(1)->getType()) << ' '
              << LT(1)->getText() << endl;
 >>
@@ -970,7 +1012,7 @@ opt_const_modifier :
 <<
 	// fail action for opt_const_modifier
 	// I can't see how we can fail this, but we seem to manage
-	cerr << "failed opt_const_modifier for token "
+	pu->error_stream() << "failed opt_const_modifier for token "
   	     << static_cast<int>(LT(1)->getType()) << ' '
 	     << LT(1)->getText() << endl;
 >>
@@ -83,23 +83,7 @@ extern char *skip_identifiers[SKIP_IDENTIFIERS_ARRAY_SIZE];
 #define zzTRACE_RULES
 #include "AParser.h"
 
-#define COUNT_TAG_NUMBER_OF_MODULES                     "NOM"
-#define COUNT_TAG_LINES_OF_CODE                         "LOC"
-#define COUNT_TAG_CYCLOMATIC_NUMBER                     "MVG"
-#define COUNT_TAG_LINES_OF_COMMENT                      "COM"
-#define COUNT_TAG_INTERMODULE_COMPLEXITY4               "IF4" // may take VISIBLE, CONCRETE suffixes
-#define COUNT_TAG_VISIBLE_SUFFIX                        "v"
-#define COUNT_TAG_CONCRETE_SUFFIX                       "c"
-
-#define COUNT_TAG_COUPLING_BETWEEN_OBJECTS              "CBO"
-#define COUNT_TAG_NUMBER_OF_CHILDREN                    "NOC"
-#define COUNT_TAG_INHERITANCE_TREE_DEPTH                "DIT"
-#define COUNT_TAG_FAN_IN                                "FI"
-#define COUNT_TAG_FAN_OUT                               "FO"
-#define COUNT_TAG_WEIGHTED_METHODS_PER_CLASS            "WMC"   // may take VISIBLE suffix
-#define COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY      "WMC1"
-
-#define COUNT_TAG_MAX_LINES_OF_CODE_PER_METHOD          "MLOCpM" // must be used at module get_count level - doesn't make sense to sum
+#include "cccc_mdf.h"
 
 #endif
 
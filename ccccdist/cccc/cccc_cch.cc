@@ -0,0 +1,148 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+// cccc_cch.cc
+
+#include "cccc_cch.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cstdio>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "cccc_itm.h"
+#include "cccc_opt.h"
+#include "cccc_ver.h"
+
+// every complete entry ends with this line
+static const string CACHE_END_PREFIX="CCCC_CacheEnd";
+
+CCCC_ResultCache::CCCC_ResultCache(const string& _directory)
+  : directory(_directory)
+{
+  options_signature=CCCC_VERSION_STRING;
+  options_signature+="@"+CCCC_Options::dialectKeywordSignature();
+}
+
+string CCCC_ResultCache::EntryPath(const string& key) const
+{
+  return directory+"/"+key+".db";
+}
+
+string CCCC_ResultCache::Key(const string& text, const string& language) const
+{
+  // The length of the text is added to the hash to make the chance of
+  // two different files sharing a key smaller still.
+  ostringstream key;
+  key << ContentHash(options_signature+"@"+language+"@"+text)
+      << "-" << text.size();
+  return key.str();
+}
+
+bool CCCC_ResultCache::Load(const string& key, const string& filename,
+			    ParseRecordList& records) const
+{
+  ifstream entry_file(EntryPath(key).c_str());
+  if(!entry_file)
+    {
+      return false;
+    }
+
+  ParseRecordList loaded;
+  bool complete=false;
+  CCCC_Item line;
+  while(complete==false && line.FromFile(entry_file))
+    {
+      string type;
+      line.Extract(type);
+      if(type==CACHE_END_PREFIX)
+	{
+	  complete=true;
+	}
+      else
+	{
+	  ParseRecordType rt=static_cast<ParseRecordType>(atoi(type.c_str()));
+	  CCCC_Item record;
+	  string value;
+	  for(size_t field=0; line.Extract(value); field++)
+	    {
+	      if(field==ParseStore::filename_field(rt))
+		{
+		  value=filename;
+		}
+	      record.Insert(value);
+	    }
+	  loaded.push_back(ParseRecord(rt,record));
+	}
+    }
+
+  if(complete)
+    {
+      records.insert(records.end(),loaded.begin(),loaded.end());
+    }
+  return complete;
+}
+
+bool CCCC_ResultCache::Save(const string& key, 
+			    const ParseRecordList& records) const
+{
+  ostringstream temp_path;
+  temp_path << EntryPath(key) << "." << getpid() << "." 
+	    << std::this_thread::get_id() << ".tmp";
+  ofstream entry_file(temp_path.str().c_str());
+
+  ParseRecordList::const_iterator recIter;
+  for(recIter=records.begin(); recIter!=records.end(); ++recIter)
+    {
+      ParseRecordType rt=(*recIter).first;
+      CCCC_Item record=(*recIter).second;
+      CCCC_Item line;
+      line.Insert(static_cast<int>(rt));
+      string value;
+      for(size_t field=0; record.Extract(value); field++)
+	{
+	  if(field==ParseStore::filename_field(rt))
+	    {
+	      value="";
+	    }
+	  line.Insert(value);
+	}
+      line.ToFile(entry_file);
+    }
+  CCCC_Item end_line;
+  end_line.Insert(CACHE_END_PREFIX);
+  end_line.ToFile(entry_file);
+  entry_file.close();
+
+  bool retval=false;
+  if(entry_file.good() && 
+     rename(temp_path.str().c_str(),EntryPath(key).c_str())==0)
+    {
+      retval=true;
+    }
+  else
+    {
+      remove(temp_path.str().c_str());
+    }
+  return retval;
+}
@@ -0,0 +1,64 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+/*
+ * cccc_cch.h
+ * 
+ * a cache of the records found by parsing source files, which may be 
+ * shared between runs, and between the agents on one machine
+ */
+#ifndef CCCC_CCH_H
+#define CCCC_CCH_H
+
+#include <string>
+
+#include "cccc.h"
+#include "cccc_utl.h"
+
+using std::string;
+
+// CCCC_ResultCache keeps the records found by parsing each file in a 
+// directory, one file for each entry, under a key made from a hash of 
+// the text of the file, the language it was parsed as, the dialect 
+// options in force and the version of the program.  The name of the 
+// source file is left out of the records, so an entry serves any file 
+// with the same content.  Each entry is written to a temporary file 
+// and renamed into place, so runs going on at the same time may share 
+// the directory.
+class CCCC_ResultCache
+{
+  string directory;
+  string options_signature;
+
+  string EntryPath(const string& key) const;
+
+ public:
+  // the options must have been loaded before the cache is created
+  CCCC_ResultCache(const string& directory);
+
+  string Key(const string& text, const string& language) const;
+
+  // Load appends the records in an entry to the list, putting back the
+  // name of the file they are for, and returns false if there is no
+  // such entry, or it is incomplete.
+  bool Load(const string& key, const string& filename, 
+	    ParseRecordList& records) const;
+  bool Save(const string& key, const ParseRecordList& records) const;
+};
+
+#endif // CCCC_CCH_H
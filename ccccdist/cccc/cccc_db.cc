@@ -18,6 +18,7 @@
 */
 #include "cccc.h"
 #include <fstream>
+#include <sstream>
 
 #include "cccc_itm.h"
 #include "cccc_db.h"
@@ -62,6 +63,18 @@ bool PeekAtNextLinePrefix(ifstream& ifstr, string pfx)
   return retval;
 }
 
+CCCC_DbInputStream::CCCC_DbInputStream(const string& filename)
+  : ifstream(filename.c_str())
+{
+  if(good())
+    {
+      std::ostringstream contents;
+      contents << ifstream::rdbuf();
+      text.str(contents.str());
+      basic_ios<char>::rdbuf(&text);
+    }
+}
+
 // this is a sort of abstract junkyard function (cf Abstract Factory)
 template <class T> void DisposeOfImportRecord(T *record_ptr, int fromfile_status)
 {
@@ -110,6 +123,14 @@ void Resolve_Fields(string& field1, string& field2)
     }
 }
 
+void Resolve_Fields(Symbol& field1, Symbol field2)
+{
+  if(field1==SymbolTable::EMPTY)
+    {
+      field1=field2;
+    }
+}
+
 template 
 void 
 DisposeOfImportRecord(CCCC_Module *record_ptr, int fromfile_status); 
@@ -122,8 +143,4 @@ template
 void 
 DisposeOfImportRecord(CCCC_UseRelationship *record_ptr, int fromfile_status);
 
-template 
-void 
-DisposeOfImportRecord(CCCC_Extent *record_ptr, int fromfile_status);
-
 
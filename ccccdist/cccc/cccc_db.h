@@ -56,6 +56,17 @@ enum GeneralFromFileStatuses
 // leaving the get pointer at the start of that token. 
 bool PeekAtNextLinePrefix(ifstream& ifstr, string pfx);
 
+// The persistence functions take an ifstream, and peek at each line 
+// before they read it, which costs a seek on the file each time.
+// CCCC_DbInputStream reads the whole of a database file into memory
+// when it is opened, so that the peeks and reads which follow are 
+// made against the copy in memory.
+class CCCC_DbInputStream : public ifstream
+{
+  std::stringbuf text;
+ public:
+  CCCC_DbInputStream(const string& filename);
+};
 
 
 // These are global variables because I don't want to have
@@ -73,6 +84,7 @@ extern int ifstr_line;
 template <class T> void DisposeOfImportRecord(T *record_ptr, int fromfile_status);
 
 void Resolve_Fields(string& field1, string& field2);
+void Resolve_Fields(Symbol& field1, Symbol field2);
 
 
 #endif // CCCC_DB_H
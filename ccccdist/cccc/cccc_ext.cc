@@ -20,15 +20,44 @@
  * cccc_ext.cc
  */
 
+#include <algorithm>
+
 #include "cccc_itm.h"
 #include "cccc_ext.h"
 #include "cccc_db.h"
 #include "cccc_utl.h"
 
-unsigned int CCCC_Extent::nextkey=0;
+thread_local unsigned long long CCCC_Extent::nextkey=0;
+
+void CCCC_Extent::set_key_block(unsigned int block)
+{
+  nextkey=static_cast<unsigned long long>(block)<<32;
+}
+
+void CCCC_Extent::set_key(unsigned int block, unsigned int position)
+{
+  extkey=(static_cast<unsigned long long>(block)<<32)+position;
+}
+
+// the tags of the lexical counts, indexed by LexicalCount
+static const char *lexical_count_tags[tcLAST]=
+{
+  COUNT_TAG_LINES_OF_COMMENT,
+  COUNT_TAG_LINES_OF_CODE,
+  COUNT_TAG_CYCLOMATIC_NUMBER
+};
+
+// and the order they are written in
+static const LexicalCount lexical_count_order[tcLAST]=
+{
+  tcCODELINES, tcCOMLINES, tcMCCABES_VG
+};
 
 CCCC_Extent::CCCC_Extent()
 {
+  filename=description=flags=SymbolTable::EMPTY;
+  linenumber=0;
+  set_counts("");
   v=vINVALID;
   ut=utINVALID;
   extkey=++nextkey;
@@ -37,42 +66,44 @@ CCCC_Extent::CCCC_Extent()
 CCCC_Extent::CCCC_Extent(CCCC_Item& is) 
 {
   char v_as_char='!', ut_as_char='!';
- 
-  if(
+  string count_buffer;
+
+  filename=description=flags=SymbolTable::EMPTY;
+  linenumber=0;
+  bool extracted=
      is.Extract(filename) &&
      is.Extract(linenumber) &&
      is.Extract(description) &&
      is.Extract(flags) &&
      is.Extract(count_buffer) &&
      is.Extract(v_as_char) &&
-     is.Extract(ut_as_char)
-     ) 
+     is.Extract(ut_as_char);
+  set_counts(count_buffer);
+  if(extracted) 
     {
-      v=(Visibility) v_as_char;
-      ut=(UseType) ut_as_char;
+      v=v_as_char;
+      ut=ut_as_char;
     }
   else
     {
-      // we can trust the string constructor to give us empty strings,
-      // but we need to initialise these
       v=vDONTKNOW;
       ut=utDONTKNOW;
     }
   extkey=++nextkey;
 }
 
-int CCCC_Extent::AddToItem(CCCC_Item& item)
+int CCCC_Extent::AddToItem(CCCC_Item& item) const
 {
   int retval=FALSE;
   
   if(
-     item.Insert(filename) &&
+     item.Insert(SymbolTable::text(filename)) &&
      item.Insert(linenumber) &&
-     item.Insert(description) &&
-     item.Insert(flags) &&
-     item.Insert(count_buffer) &&
-     item.Insert((char) v) &&
-     item.Insert((char) ut)
+     item.Insert(SymbolTable::text(description)) &&
+     item.Insert(SymbolTable::text(flags)) &&
+     item.Insert(count_text()) &&
+     item.Insert(v) &&
+     item.Insert(ut)
      )
     {
       retval=TRUE;
@@ -85,6 +116,7 @@ int CCCC_Extent::GetFromItem(CCCC_Item &item)
 {
   int retval=FALSE;
   char v_as_char, ut_as_char;
+  string count_buffer;
   if(
      item.Extract(filename) &&
      item.Extract(linenumber) &&
@@ -95,8 +127,9 @@ int CCCC_Extent::GetFromItem(CCCC_Item &item)
      item.Extract(ut_as_char)
      )
     {
-      v = (Visibility) v_as_char;
-      ut = (UseType) ut_as_char;
+      set_counts(count_buffer);
+      v = v_as_char;
+      ut = ut_as_char;
       retval=TRUE;
     }
 
@@ -104,59 +137,201 @@ int CCCC_Extent::GetFromItem(CCCC_Item &item)
 }
 
 
+bool CCCC_Extent::is_equivalent(const CCCC_Extent& other) const
+{
+  return 
+    filename==other.filename &&
+    linenumber==other.linenumber &&
+    description==other.description &&
+    flags==other.flags &&
+    count_state==other.count_state &&
+    std::equal(counts,counts+tcLAST,other.counts) &&
+    v==other.v &&
+    ut==other.ut;
+}
+
 string CCCC_Extent::name(int level) const
 {
   string rtnbuf;
-
-  rtnbuf="";
+  char buf[24];
 
   switch(level)
     {
     case nlFILENAME:
-      rtnbuf=filename;
+      rtnbuf=SymbolTable::text(filename);
       break;
     case nlLINENUMBER:
-      rtnbuf=linenumber;
+      sprintf(buf,"%d",linenumber);
+      rtnbuf=buf;
       break;
     case nlDESCRIPTION:
-      rtnbuf=description;
-      break;
-    case nlSEARCH:
-    case nlRANK:
-      // Extents have no meaningful internal primary key.
-      // We never want two extents to have the same
-      // key, so we use the running number extkey
-      // which is initialized in both constructors.
-      // This should cause extents to sort in order of
-      // their creation, which is fine.
-      char buf[16];
-      sprintf(buf,"%015d",extkey);
-      rtnbuf=buf;
+      rtnbuf=SymbolTable::text(description);
       break;
+    default:
+      sprintf(buf,":%d",linenumber);
+      rtnbuf=SymbolTable::text(filename);
+      rtnbuf+=buf;
+    }
+  return rtnbuf;
+}
 
+int CCCC_Extent::get_count(MetricId count_id) const {
+  int retval=0;
+  switch(count_id)
+    {
+    case miLOC:
+      retval=counts[tcCODELINES];
+      break;
+    case miCOM:
+      retval=counts[tcCOMLINES];
+      break;
+    case miMVG:
+      retval=counts[tcMCCABES_VG];
+      break;
     default:
-      rtnbuf+=filename;
-      rtnbuf+=":";
-      rtnbuf+=linenumber;
+      break;
     }
-  return rtnbuf.c_str();
+  return retval;
 }
 
-string CCCC_Extent::key() const { return name(nlRANK); }
+void CCCC_Extent::set_counts(const string& count_text)
+{
+  std::fill(counts,counts+tcLAST,0);
+  if(count_text.size()==0)
+    {
+      count_state=csEMPTY;
+    }
+  else if(count_text=="*")
+    {
+      count_state=csUNALLOCATED;
+    }
+  else
+    {
+      // The text is picked apart by hand rather than with strtok, which
+      // keeps its place in static storage.  Tags other than those of 
+      // the lexical counts are dropped.
+      count_state=csALLOCATED;
+      string::size_type tag_start=0;
+      while(tag_start<count_text.size())
+	{
+	  string::size_type tag_end=count_text.find(':',tag_start);
+	  if(tag_end==string::npos)
+	    {
+	      break;
+	    }
+	  string::size_type value_end=count_text.find(' ',tag_end+1);
+	  if(value_end==string::npos)
+	    {
+	      value_end=count_text.size();
+	    }
+	  for(int i=0; i<tcLAST; i++)
+	    {
+	      if(count_text.compare(tag_start,tag_end-tag_start,
+				    lexical_count_tags[i])==0)
+		{
+		  counts[i]+=atoi(count_text.c_str()+tag_end+1);
+		}
+	    }
+	  tag_start=value_end+1;
+	}
+    }
+}
 
-int CCCC_Extent::get_count(const char* count_tag) {
-  int retval=0;
-  char local_count_buffer[100], *count_tag_ptr, *count_value_ptr;
-  strcpy(local_count_buffer,count_buffer.c_str());
-  count_tag_ptr=strtok(local_count_buffer,":");
-  while(count_tag_ptr!=NULL)
+string CCCC_Extent::count_text() const
+{
+  string retval;
+  switch(count_state)
     {
-      count_value_ptr=strtok(NULL," ");
-      if(strcmp(count_tag_ptr, count_tag) ==0)
+    case csEMPTY:
+      break;
+    case csUNALLOCATED:
+      retval="*";
+      break;
+    case csALLOCATED:
+      retval=count_text(counts);
+      break;
+    }
+  return retval;
+}
+
+string CCCC_Extent::count_text(const int lexical_counts[tcLAST])
+{
+  string retval;
+  char buf[24];
+  for(int i=0; i<tcLAST; i++)
+    {
+      LexicalCount lc=lexical_count_order[i];
+      if(i>0)
 	{
-	  retval+=atoi(count_value_ptr);
+	  retval+=' ';
 	}
-      count_tag_ptr=strtok(NULL,":");
+      retval+=lexical_count_tags[lc];
+      sprintf(buf,":%d",lexical_counts[lc]);
+      retval+=buf;
+    }
+  return retval;
+}
+
+static bool key_less(const CCCC_Extent& e1, const CCCC_Extent& e2)
+{
+  return e1.get_key()<e2.get_key();
+}
+
+bool CCCC_ExtentList::insert(const CCCC_Extent& extent)
+{
+  bool retval=true;
+  if(extents.empty() || extents.back().get_key()<extent.get_key())
+    {
+      extents.push_back(extent);
+    }
+  else
+    {
+      iterator iter=std::lower_bound(extents.begin(),extents.end(),
+				     extent,key_less);
+      if(iter->get_key()==extent.get_key())
+	{
+	  retval=false;
+	}
+      else
+	{
+	  extents.insert(iter,extent);
+	}
+    }
+  return retval;
+}
+
+void CCCC_ExtentList::remove(const std::set<unsigned long long>& keys)
+{
+  iterator new_end=
+    std::remove_if(extents.begin(),extents.end(),
+		   [&keys](const CCCC_Extent& extent) 
+		   { return keys.count(extent.get_key())>0; });
+  extents.erase(new_end,extents.end());
+}
+
+void CCCC_ExtentList::take_all(CCCC_ExtentList& other)
+{
+  size_t old_size=extents.size();
+  extents.insert(extents.end(),other.extents.begin(),other.extents.end());
+  std::inplace_merge(extents.begin(),extents.begin()+old_size,extents.end(),
+		     key_less);
+  other.extents.clear();
+}
+
+void CCCC_ExtentList::sort()
+{
+  if(!std::is_sorted(extents.begin(),extents.end(),key_less))
+    {
+      std::stable_sort(extents.begin(),extents.end(),key_less);
+    }
+}
+
+int CCCC_ExtentList::get_count(MetricId count_id) const
+{
+  int retval=0;
+  for(const_iterator iter=extents.begin(); iter!=extents.end(); ++iter)
+    {
+      retval+=iter->get_count(count_id);
     }
   return retval;
 }
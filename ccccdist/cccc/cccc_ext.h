@@ -22,10 +22,13 @@
 #ifndef CCCC_EXT_H
 #define CCCC_EXT_H
 
+#include <set>
 #include <string>
+#include <vector>
 using std::string;
 
 #include "cccc_utl.h"
+#include "cccc_sym.h"
 
 class CCCC_Item;
 
@@ -34,28 +37,97 @@ class CCCC_Extent
 {
   friend class CCCC_Record;
   friend class CCCC_Project;
-  
-  string filename;
-  string linenumber;
-  string description;
-  string flags;
-  string count_buffer;
-  UseType ut;
-  Visibility v;
-  static unsigned int nextkey;
-  unsigned int extkey;
+
+  // An extent is held by value in the list of its record, so it is kept
+  // small: the strings it refers to are interned, and the line number is 
+  // held as the integer the analyzer wrote out.
+  unsigned long long extkey;
+  Symbol filename;
+  Symbol description;
+  Symbol flags;
+  int linenumber;
+
+  // The lexical counts of an extent are held as integers indexed by 
+  // LexicalCount.  In the database they are written as space-separated 
+  // TAG:value pairs, or as "*" for an extent to which no counts were 
+  // allocated, or left empty (as for the builtin types).
+  enum CountState { csEMPTY, csUNALLOCATED, csALLOCATED };
+  int counts[tcLAST];
+  char count_state;
+  void set_counts(const string& count_text);
+  string count_text() const;
+
+  char ut;
+  char v;
+  static thread_local unsigned long long nextkey;
  public:
   CCCC_Extent();
   CCCC_Extent(CCCC_Item& is);
 
+  // Extents sort in the order they were created within a block of keys.
+  // Each file parsed is given a block of its own, numbered by its place
+  // in the file list, so that extents sort in the same order however
+  // many threads the files are spread across.
+  static void set_key_block(unsigned int block);
+
+  // An incremental run moves the extents it keeps from the previous 
+  // run's database into the blocks of the files they came from.
+  void set_key(unsigned int block, unsigned int position);
+  unsigned long long get_key() const { return extkey; }
+  Symbol get_filename() const { return filename; }
+  int get_linenumber() const { return linenumber; }
+
   string name( int index ) const;
-  string key() const; 
   int GetFromItem(CCCC_Item& item);
-  int AddToItem(CCCC_Item& item);
-  Visibility get_visibility() const { return v; }
-  int get_count(const char *count_tag);
-  UseType get_usetype() const { return ut; }
-  const char* get_description() const { return description.c_str(); }
+  int AddToItem(CCCC_Item& item) const;
+  Visibility get_visibility() const { return (Visibility) v; }
+  int get_count(MetricId count_id) const;
+  int get_count(LexicalCount lc) const { return counts[lc]; }
+  UseType get_usetype() const { return (UseType) ut; }
+
+  // true if the other extent has the same content as this one
+  // (the running key is not compared)
+  bool is_equivalent(const CCCC_Extent& other) const;
+  const char* get_description() const 
+    { return SymbolTable::text(description).c_str(); }
+
+  // the text of a set of allocated counts, as it is written out
+  static string count_text(const int lexical_counts[tcLAST]);
+};
+
+// The extents of a record are held side by side in order of their keys.
+// Extents nearly always arrive in that order, so adding one is usually 
+// an append.
+class CCCC_ExtentList
+{
+  std::vector<CCCC_Extent> extents;
+ public:
+  typedef std::vector<CCCC_Extent>::iterator iterator;
+  typedef std::vector<CCCC_Extent>::const_iterator const_iterator;
+
+  iterator begin() { return extents.begin(); }
+  iterator end() { return extents.end(); }
+  const_iterator begin() const { return extents.begin(); }
+  const_iterator end() const { return extents.end(); }
+  size_t size() const { return extents.size(); }
+  bool empty() const { return extents.empty(); }
+  int records() const { return extents.size(); }
+  void clear() { extents.clear(); }
+
+  // returns false, leaving the list as it was, if an extent with the 
+  // same key is already held
+  bool insert(const CCCC_Extent& extent);
+
+  // drops the extents with any of the keys
+  void remove(const std::set<unsigned long long>& keys);
+
+  // moves the extents of the other list into this one
+  void take_all(CCCC_ExtentList& other);
+
+  // restores the order of the keys after they have been changed
+  void sort();
+
+  int get_count(MetricId count_id) const;
 };
 
 #endif // CCCC_EXT_H
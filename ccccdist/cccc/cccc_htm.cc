@@ -41,19 +41,17 @@
 
 #include <time.h>
 #include <sys/stat.h>
+#include <vector>
+#include <thread>
+#include <mutex>
 #include "cccc_utl.h"
+#include "cccc_src.h"
 
 #ifndef COUNTOF
 #  define COUNTOF(x) (sizeof(x)/sizeof(*(x)))
 #endif
 
-typedef std::map<string,Source_Anchor> source_anchor_map_t;
-source_anchor_map_t source_anchor_map;
-
-
 // class static data members
-CCCC_Project* CCCC_Html_Stream::prjptr;
-string CCCC_Html_Stream::outdir;
 string CCCC_Html_Stream::libdir;
 
 struct metric_description_t {
@@ -62,76 +60,25 @@ struct metric_description_t {
     const char* description;
 };
 
-static metric_description_t ProjectSummaryMetrics[] = {
-        { COUNT_TAG_NUMBER_OF_MODULES, "Number of modules",
-                "Number of non-trivial modules identified by the "
-                "analyser.  Non-trivial modules include all classes, "
-                "and any other module for which member functions are "
-                "identified." },
-        { COUNT_TAG_LINES_OF_CODE, "Lines of Code",
-                "Number of non-blank, non-comment lines of source code "
-                "counted by the analyser." },
-        { COUNT_TAG_LINES_OF_COMMENT, "Lines of Comments",
-                "Number of lines of comment identified by the analyser" },
-        { COUNT_TAG_CYCLOMATIC_NUMBER, "McCabe's Cyclomatic Complexity",
-                "A measure of the decision complexity of the functions "
-                "which make up the program."
-                "The strict definition of this measure is that it is "
-                "the number of linearly independent routes through "
-                "a directed acyclic graph which maps the flow of control "
-                "of a subprogram.  The analyser counts this by recording "
-                "the number of distinct decision outcomes contained "
-                "within each function, which yields a good approximation "
-                "to the formally defined version of the measure." },
-        { "L_C","Lines of code per line of comment",
-                "Indicates density of comments with respect to textual "
-                "size of program" },
-        { "M_C","Cyclomatic Complexity per line of comment",
-                "Indicates density of comments with respect to logical "
-                "complexity of program" },
-        { COUNT_TAG_INTERMODULE_COMPLEXITY4, "Information Flow measure",
-                "Measure of information flow between modules suggested "
-                "by Henry and Kafura. The analyser makes an approximate "
-                "count of this by counting inter-module couplings "
-                "identified in the module interfaces." },
-        { "LOCpM", "Lines of Code per Method",
-                "The average number of lines of code per method. "
-                "High LoC count may indicate poor functional isolation. "
-                "Note that this measure may be weighted low by large numbers of small accessor methods." },
-        { "MLOCpM", "Max Lines of Code per Method",
-                "The largest number of lines of code in a single method. "
-                "High LoC count may indicate poor functional isolation." },
+static metric_description_t describe_metric(MetricId metric_id)
+{
+    const MetricDefinition& definition=metric_definitions[metric_id];
+    metric_description_t retval =
+        { definition.tag, definition.name, definition.description };
+    return retval;
+}
+
+// the names and descriptions of these are held in metric_definitions
+static const MetricId ProjectSummaryMetrics[] = {
+        miNOM, miLOC, miCOM, miMVG, miL_C, miM_C, miIF4, miLOCpM, miMLOCpM
 };
 
-#define _WMC_DESCRIPTION_START "The sum of a weighting function over the functions of the module. "
-#define _WMC_NAME_START "Weighted methods per class"
-static metric_description_t OODesignMetrics[] = {
-        { COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY, _WMC_NAME_START " (all)",
-                _WMC_DESCRIPTION_START "WMC1 uses the nominal weight of 1 for each "
-                "function, and hence measures the number of functions." },
-        { COUNT_TAG_WEIGHTED_METHODS_PER_CLASS COUNT_TAG_VISIBLE_SUFFIX, _WMC_NAME_START " (visible)",
-                _WMC_DESCRIPTION_START "WMCv uses a weighting function which is 1 for functions "
-                "accessible to other modules, 0 for private functions."},
-        { COUNT_TAG_INHERITANCE_TREE_DEPTH, "Depth of inheritance tree",
-                "The length of the longest path of inheritance ending at "
-                "the current module.  The deeper the inheritance tree "
-                "for a module, the harder it may be to predict its "
-                "behaviour.  On the other hand, increasing depth gives "
-                "the potential of greater reuse by the current module "
-                "of behaviour defined for ancestor classes." },
-        { COUNT_TAG_NUMBER_OF_CHILDREN, "Number of children",
-                "The number of modules which inherit directly from the "
-                "current module.  Moderate values of this measure "
-                "indicate scope for reuse, however high values may "
-                "indicate an inappropriate abstraction in the design." },
-        { COUNT_TAG_COUPLING_BETWEEN_OBJECTS, "Coupling between objects",
-                "The number of other modules which are coupled to the "
-                "current module either as a client or a supplier. "
-                "Excessive coupling indicates weakness of module "
-                "encapsulation and may inhibit reuse." }
+static const MetricId OODesignMetrics[] = {
+        miWMC1, miWMCv, miDIT, miNOC, miCBO
 };
 
-static metric_description_t StructuralSummaryMetrics[] = {
+// the entries of this table each describe a group of metrics
+static const metric_description_t StructuralSummaryMetrics[] = {
         { "Fan-in", "",
                    "The number of other modules which pass information "
                    "into the current module." },
@@ -148,12 +95,12 @@ static metric_description_t StructuralSummaryMetrics[] = {
 void CCCC_Html_Stream::GenerateReports(CCCC_Project* prj,
 				       int report_mask,
 				       const string& file,
-				       const string& dir)
+				       const string& dir,
+				       int threads,
+				       CCCC_PageManifest *manifest)
 {
-  prjptr=prj;
-  outdir=dir;
-
-  CCCC_Html_Stream main_html_stream(file.c_str(),"Report on software metrics");
+  CCCC_Html_Stream main_html_stream(file.c_str(),"Report on software metrics",
+				    prj,dir);
 
   if(report_mask & rtCONTENTS)
     {
@@ -203,7 +150,7 @@ void CCCC_Html_Stream::GenerateReports(CCCC_Project* prj,
 
   if(report_mask & rtSEPARATE_MODULES)
     {
-      main_html_stream.Separate_Modules();
+      main_html_stream.Separate_Modules(threads,manifest);
     }
 
   if(report_mask & rtOTHER)
@@ -243,7 +190,90 @@ void CCCC_Html_Stream::GenerateReports(CCCC_Project* prj,
 CCCC_Html_Stream::~CCCC_Html_Stream()
 {
   fstr << "</BODY></HTML>" << endl;
-  fstr.close();
+  if(page_manifest!=NULL)
+    {
+      page_manifest->Write(page_filename,page_buffer.str());
+      fstr.basic_ios<char>::rdbuf(fstr.rdbuf());
+    }
+  else
+    {
+      fstr.close();
+    }
+}
+
+static const string PAGE_HASH_PREFIX="CCCC_PageHash";
+
+CCCC_PageManifest::CCCC_PageManifest(const string& outdir)
+: directory(outdir)
+, manifest_filename(outdir+"/cccc_pages.db")
+{
+  ifstream manifest_file(manifest_filename.c_str());
+  string line;
+  while(getline(manifest_file,line))
+    {
+      CCCC_Item page_line(line);
+      string prefix, page_filename, hash;
+      if(page_line.Extract(prefix) && prefix==PAGE_HASH_PREFIX &&
+	 page_line.Extract(page_filename) && page_line.Extract(hash))
+	{
+	  page_hashes[page_filename]=hash;
+	}
+    }
+}
+
+string CCCC_PageManifest::PageName(const string& page_filename) const
+{
+  string retval=page_filename;
+  if(page_filename.compare(0,directory.size()+1,directory+"/")==0)
+    {
+      retval=page_filename.substr(directory.size()+1);
+    }
+  return retval;
+}
+
+bool CCCC_PageManifest::Write(const string& page_filename, 
+			      const string& content)
+{
+  string hash=ContentHash(content);
+  {
+    std::lock_guard<std::mutex> lock(manifest_mutex);
+    string& recorded_hash=page_hashes[PageName(page_filename)];
+    bool unchanged=(recorded_hash==hash);
+    recorded_hash=hash;
+
+    // the page is written again if it has gone missing
+    struct stat page_stat;
+    if(unchanged && stat(page_filename.c_str(),&page_stat)==0)
+      {
+	return false;
+      }
+  }
+
+  ofstream page_file(page_filename.c_str());
+  if(page_file.good() != TRUE)
+    {
+      cerr << "failed to open " << page_filename.c_str() 
+	   << " for output" << endl;
+      exit(1);
+    }
+  page_file << content;
+  return true;
+}
+
+void CCCC_PageManifest::Save()
+{
+  // pages which were not written by this run are remembered too, in 
+  // case they are needed again
+  ofstream manifest_file(manifest_filename.c_str());
+  std::map<string,string>::iterator hashIter;
+  for(hashIter=page_hashes.begin(); hashIter!=page_hashes.end(); ++hashIter)
+    {
+      CCCC_Item page_line;
+      page_line.Insert(PAGE_HASH_PREFIX);
+      page_line.Insert((*hashIter).first);
+      page_line.Insert((*hashIter).second);
+      page_line.ToFile(manifest_file);
+    }
 }
 
 void CCCC_Html_Stream::Table_Of_Contents(int report_mask, bool showGenTime)
@@ -270,7 +300,7 @@ void CCCC_Html_Stream::Table_Of_Contents(int report_mask, bool showGenTime)
     {
       time_t generationTime=time(NULL);
       fstr << _HTMLLineBreak
-           << " generated " << ctime(&generationTime) << " by CCCC v" CCCC_VERSION_STRING << endl;
+           << " generated " << TimeString(generationTime) << " by CCCC v" CCCC_VERSION_STRING << endl;
     }
 
   fstr << HTMLEndElement(_TableRow) << endl;
@@ -387,7 +417,10 @@ void  CCCC_Html_Stream::Project_Summary() {
 
   fstr << HTMLBeginElement(_UnorderedList, "Project_Summary") << endl;
   for (int k = 0; k < COUNTOF(ProjectSummaryMetrics); ++k)
-      Metric_Description(ProjectSummaryMetrics[k].abbreviation, ProjectSummaryMetrics[k].name, ProjectSummaryMetrics[k].description);
+    {
+      metric_description_t metric=describe_metric(ProjectSummaryMetrics[k]);
+      Metric_Description(metric.abbreviation, metric.name, metric.description);
+    }
   fstr << HTMLEndElement(_UnorderedList) << endl
        << HTMLParagraph(
     	  "Two variants on the information flow measure IF4 are also "
@@ -399,14 +432,14 @@ void  CCCC_Html_Stream::Project_Summary() {
        << endl << endl;
 
   // calculate the counts on which all displayed data will be based
-  int nom=prjptr->get_count(COUNT_TAG_NUMBER_OF_MODULES);
-  int loc=prjptr->get_count(COUNT_TAG_LINES_OF_CODE);
-  int mvg=prjptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-  int com=prjptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
-  int if4=prjptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4);
-  int if4v=prjptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX);
-  int if4c=prjptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX);
-  int rej=prjptr->rejected_extent_table.get_count(COUNT_TAG_LINES_OF_CODE);
+  int nom=prjptr->get_count(miNOM);
+  int loc=prjptr->get_count(miLOC);
+  int mvg=prjptr->get_count(miMVG);
+  int com=prjptr->get_count(miCOM);
+  int if4=prjptr->get_count(miIF4);
+  int if4v=prjptr->get_count(miIF4v);
+  int if4c=prjptr->get_count(miIF4c);
+  int rej=prjptr->rejected_extent_table.get_count(miLOC);
 
   fstr << HTMLBeginElement(_Table, "summary")
        << HTMLBeginElement(_TableHead) << endl
@@ -428,35 +461,35 @@ void  CCCC_Html_Stream::Project_Summary() {
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("Lines of Code");
   Put_Label_Cell(COUNT_TAG_LINES_OF_CODE);
-  Put_Metric_Cell(loc,"LOCp");
-  Put_Metric_Cell(loc,nom,"LOCper");
+  Put_Metric_Cell(loc,tmLOCp);
+  Put_Metric_Cell(loc,nom,tmLOCper);
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("McCabe's Cyclomatic Number");
   Put_Label_Cell(COUNT_TAG_CYCLOMATIC_NUMBER);
-  Put_Metric_Cell(mvg,"MVGp");
-  Put_Metric_Cell(mvg,nom,"MVGper");
+  Put_Metric_Cell(mvg,tmMVGp);
+  Put_Metric_Cell(mvg,nom,tmMVGper);
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("Lines of Comment");
   Put_Label_Cell(COUNT_TAG_LINES_OF_COMMENT);
-  Put_Metric_Cell(com,"COM");
-  Put_Metric_Cell(com,nom,"COMper");
+  Put_Metric_Cell(com,tmCOM);
+  Put_Metric_Cell(com,nom,tmCOMper);
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("LOC/COM");
   Put_Label_Cell("L_C");
-  Put_Metric_Cell(loc,com,"L_C");
+  Put_Metric_Cell(loc,com,tmL_C);
   fstr << HTMLTableCell("");
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("MVG/COM");
   Put_Label_Cell("M_C");
-  Put_Metric_Cell(mvg,com,"M_C");
+  Put_Metric_Cell(mvg,com,tmM_C);
   fstr << HTMLTableCell("");
   fstr << HTMLEndElement(_TableRow) << endl;
 
@@ -464,27 +497,27 @@ void  CCCC_Html_Stream::Project_Summary() {
   Put_Label_Cell("Information Flow measure (inclusive)");
   Put_Label_Cell(COUNT_TAG_INTERMODULE_COMPLEXITY4);
   Put_Metric_Cell(if4);
-  Put_Metric_Cell(if4,nom,"8.3");
+  Put_Metric_Cell(if4,nom,tm8_3);
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("Information Flow measure (visible)");
   Put_Label_Cell(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX);
   Put_Metric_Cell(if4v);
-  Put_Metric_Cell(if4v,nom,"8.3");
+  Put_Metric_Cell(if4v,nom,tm8_3);
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("Information Flow measure (concrete)");
   Put_Label_Cell(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX);
   Put_Metric_Cell(if4c);
-  Put_Metric_Cell(if4c,nom,"8.3");
+  Put_Metric_Cell(if4c,nom,tm8_3);
   fstr << HTMLEndElement(_TableRow) << endl;
 
   fstr << HTMLBeginElement(_TableRow) << endl;
   Put_Label_Cell("Lines of Code rejected by parser");
   Put_Label_Cell("REJ");
-  Put_Metric_Cell(rej,"REJ");
+  Put_Metric_Cell(rej,tmREJ);
   fstr << HTMLTableCell("");
   fstr << HTMLEndElement(_TableRow) << endl;
 
@@ -497,7 +530,10 @@ void CCCC_Html_Stream::OO_Design() {
 
   fstr << HTMLBeginElement(_UnorderedList) << endl;
   for (size_t k = 0; k < metric_tag_count; ++k)
-      Metric_Description(OODesignMetrics[k].abbreviation, OODesignMetrics[k].name, OODesignMetrics[k].description);
+    {
+      metric_description_t metric=describe_metric(OODesignMetrics[k]);
+      Metric_Description(metric.abbreviation, metric.name, metric.description);
+    }
   fstr << HTMLEndElement(_UnorderedList) << endl << endl;
 
   fstr << HTMLParagraph(
@@ -512,15 +548,16 @@ void CCCC_Html_Stream::OO_Design() {
 
   Put_Header_Cell("Module Name", 100 - 10 * metric_tag_count);
   for (size_t k = 0; k < metric_tag_count; ++k)
-      Put_Header_Cell(OODesignMetrics[k].abbreviation, 10);
+      Put_Header_Cell(metric_definitions[OODesignMetrics[k]].tag, 10);
 
   fstr << HTMLEndElement(_TableRow)
        << HTMLEndElement(_TableHead) << endl;
 
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
   int i=0;
-  while(mod_ptr!=NULL)
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       i++;
       if( mod_ptr->is_trivial() == FALSE)
 	{
@@ -532,13 +569,14 @@ void CCCC_Html_Stream::OO_Design() {
 
 	  for(size_t j=0; j < metric_tag_count; j++)
 	    {
-	      CCCC_Metric metric_value(mod_ptr->get_count(OODesignMetrics[j].abbreviation), OODesignMetrics[j].abbreviation);
+	      MetricId metric_id=OODesignMetrics[j];
+	      CCCC_Metric metric_value(mod_ptr->get_count(metric_id), metric_definitions[metric_id].treatment);
 	      Put_Metric_Cell(metric_value);
 	    }
 	  fstr << HTMLEndElement(_TableRow) << endl;
 
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
 
   fstr << HTMLEndElement(_Table) << endl;
@@ -572,10 +610,11 @@ void CCCC_Html_Stream::Procedural_Summary() {
   fstr << HTMLEndElement(_TableRow)
 	   << HTMLEndElement(_TableHead) << endl;
 
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
   int i=0;
-  while(mod_ptr!=NULL)
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       i++;
       if( mod_ptr->is_trivial() == FALSE)
 	{
@@ -583,22 +622,22 @@ void CCCC_Html_Stream::Procedural_Summary() {
 	  string href=mod_ptr->key()+".html#procdet";
 
 	  Put_Label_Cell(mod_ptr->name(nlSIMPLE).c_str(),0,"",href.c_str());
-	  int loc=mod_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-	  int mvg=mod_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-	  int com=mod_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
+	  int loc=mod_ptr->get_count(miLOC);
+	  int mvg=mod_ptr->get_count(miMVG);
+	  int com=mod_ptr->get_count(miCOM);
 
-	  Put_Metric_Cell(CCCC_Metric(loc, "LOCm"));
-	  Put_Metric_Cell(CCCC_Metric(mvg, "MVGm"));
+	  Put_Metric_Cell(CCCC_Metric(loc, tmLOCm));
+	  Put_Metric_Cell(CCCC_Metric(mvg, tmMVGm));
 	  Put_Metric_Cell(com);
-	  Put_Metric_Cell(CCCC_Metric(loc, com, "L_C"));
-	  Put_Metric_Cell(CCCC_Metric(mvg, com, "M_C"));
-	  Put_Metric_Cell(CCCC_Metric(loc, mod_ptr->get_count(COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY), "LOCf"));
-          Put_Metric_Cell(CCCC_Metric(mod_ptr->get_count(COUNT_TAG_MAX_LINES_OF_CODE_PER_METHOD), "LOCf"));
+	  Put_Metric_Cell(CCCC_Metric(loc, com, tmL_C));
+	  Put_Metric_Cell(CCCC_Metric(mvg, com, tmM_C));
+	  Put_Metric_Cell(CCCC_Metric(loc, mod_ptr->get_count(miWMC1), tmLOCf));
+          Put_Metric_Cell(CCCC_Metric(mod_ptr->get_count(miMLOCpM), tmLOCf));
 
 	  fstr << HTMLEndElement(_TableRow) << endl;
 
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
 
   fstr << HTMLEndElement(_Table) << endl;
@@ -649,42 +688,43 @@ void CCCC_Html_Stream::Structural_Summary()
        << HTMLEndElement(_TableHead) << endl;
 
 
-  CCCC_Module* module_ptr=prjptr->module_table.first_item();
-  while(module_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* module_ptr=(*modIter).second;
       if(module_ptr->is_trivial()==FALSE)
 	{
 	  fstr << HTMLBeginElement(_TableRow) << endl;
 
-	  int fov=module_ptr->get_count(COUNT_TAG_FAN_OUT COUNT_TAG_VISIBLE_SUFFIX);
-	  int foc=module_ptr->get_count(COUNT_TAG_FAN_OUT COUNT_TAG_CONCRETE_SUFFIX);
-	  int fo=module_ptr->get_count(COUNT_TAG_FAN_OUT);
+	  int fov=module_ptr->get_count(miFOv);
+	  int foc=module_ptr->get_count(miFOc);
+	  int fo=module_ptr->get_count(miFO);
 
-	  int fiv=module_ptr->get_count(COUNT_TAG_FAN_IN COUNT_TAG_VISIBLE_SUFFIX);
-	  int fic=module_ptr->get_count(COUNT_TAG_FAN_IN COUNT_TAG_CONCRETE_SUFFIX);
-	  int fi=module_ptr->get_count(COUNT_TAG_FAN_IN);
+	  int fiv=module_ptr->get_count(miFIv);
+	  int fic=module_ptr->get_count(miFIc);
+	  int fi=module_ptr->get_count(miFI);
 
-	  int if4v=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX);
-	  int if4c=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX);
-	  int if4=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4);
+	  int if4v=module_ptr->get_count(miIF4v);
+	  int if4c=module_ptr->get_count(miIF4c);
+	  int if4=module_ptr->get_count(miIF4);
 
 	  // the last two arguments here turn on links to enable jumping between
 	  // the summary and detail cells for the same module
 	  string href=module_ptr->key()+".html#structdet";
 	  Put_Label_Cell(module_ptr->name(nlSIMPLE).c_str(), 0, "",href.c_str());
-	  Put_Metric_Cell(CCCC_Metric(fov,"FOv"));
-	  Put_Metric_Cell(CCCC_Metric(foc,"FOc"));
-	  Put_Metric_Cell(CCCC_Metric(fo,"FO"));
-	  Put_Metric_Cell(CCCC_Metric(fiv,"FIv"));
-	  Put_Metric_Cell(CCCC_Metric(fic,"FIc"));
-	  Put_Metric_Cell(CCCC_Metric(fi,"FI"));
-	  Put_Metric_Cell(CCCC_Metric(if4v,"IF4v"));
-	  Put_Metric_Cell(CCCC_Metric(if4c,"IF4c"));
-	  Put_Metric_Cell(CCCC_Metric(if4,"IF4"));
+	  Put_Metric_Cell(CCCC_Metric(fov,tmFOv));
+	  Put_Metric_Cell(CCCC_Metric(foc,tmFOc));
+	  Put_Metric_Cell(CCCC_Metric(fo,tmFO));
+	  Put_Metric_Cell(CCCC_Metric(fiv,tmFIv));
+	  Put_Metric_Cell(CCCC_Metric(fic,tmFIc));
+	  Put_Metric_Cell(CCCC_Metric(fi,tmFI));
+	  Put_Metric_Cell(CCCC_Metric(if4v,tmIF4v));
+	  Put_Metric_Cell(CCCC_Metric(if4c,tmIF4c));
+	  Put_Metric_Cell(CCCC_Metric(if4,tmIF4));
 
 	  fstr << HTMLEndElement(_TableRow) << endl;
 	}
-      module_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
   fstr << HTMLEndElement(_Table) << endl;
 
@@ -772,9 +812,10 @@ void CCCC_Html_Stream::Structural_Detail()
   fstr << HTMLEndElement(_TableHead)
 		  << HTMLEndElement(_TableRow) << endl;
 
-  CCCC_Module* module_ptr=prjptr->module_table.first_item();
-  while(module_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* module_ptr=(*modIter).second;
       if(module_ptr->is_trivial()==FALSE)
 	{
 	  fstr << HTMLBeginElement(_TableRow) << endl;
@@ -782,7 +823,7 @@ void CCCC_Html_Stream::Structural_Detail()
 	  Structural_Detail(module_ptr);
 	  fstr << HTMLEndElement(_TableRow) << endl;
 	}
-      module_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
   fstr << HTMLEndElement(_Table) << endl;
 
@@ -793,9 +834,10 @@ void CCCC_Html_Stream::Procedural_Detail() {
 
   fstr << HTMLBeginElement(_Table, "summary") << endl;
 
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
-  while(mod_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       if(
 	 (mod_ptr->name(nlMODULE_TYPE)!="builtin") &&
 	 (mod_ptr->name(nlMODULE_TYPE)!="enum") &&
@@ -814,7 +856,7 @@ void CCCC_Html_Stream::Procedural_Detail() {
 	  fstr << HTMLEndElement(_TableRow) << endl;
 	  Procedural_Detail(mod_ptr);
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
   fstr << HTMLEndElement(_Table) << endl;
 }
@@ -839,17 +881,18 @@ void CCCC_Html_Stream::Other_Extents()
     }
   else
     {
-      CCCC_Extent *extent_ptr=prjptr->rejected_extent_table.first_item();
-      while(extent_ptr!=NULL)
+      CCCC_Record::Extent_Table::iterator extIter=prjptr->rejected_extent_table.begin();
+      while(extIter!=prjptr->rejected_extent_table.end())
 	{
+	  CCCC_Extent *extent_ptr=&*extIter;
 	  fstr << HTMLBeginElement(_TableRow);
 	  Put_Extent_Cell(*extent_ptr,0);
 	  fstr << HTMLTableCell(HTMLEscapeLiteral(extent_ptr->name(nlDESCRIPTION).c_str()).c_str());
-	  Put_Metric_Cell(extent_ptr->get_count(COUNT_TAG_LINES_OF_CODE),"");
-	  Put_Metric_Cell(extent_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT),"");
-	  Put_Metric_Cell(extent_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER),"");
+	  Put_Metric_Cell(extent_ptr->get_count(miLOC),tmNONE);
+	  Put_Metric_Cell(extent_ptr->get_count(miCOM),tmNONE);
+	  Put_Metric_Cell(extent_ptr->get_count(miMVG),tmNONE);
 	  fstr << HTMLEndElement(_TableRow) << endl;
-	  extent_ptr=prjptr->rejected_extent_table.next_item();
+	  extIter++;
 	}
     }
   fstr << HTMLEndElement(_Table) << endl;
@@ -917,16 +960,16 @@ void CCCC_Html_Stream::Put_Label_Cell(
 
 
 void CCCC_Html_Stream::Put_Metric_Cell(
-				       int count, string tag, int width)
+				       int count, TreatmentId treatment_id, int width)
 {
-  CCCC_Metric m(count, tag.c_str());
+  CCCC_Metric m(count, treatment_id);
   Put_Metric_Cell(m, width);
 }
 
 void CCCC_Html_Stream::Put_Metric_Cell(
-				       int num, int denom, string tag, int width)
+				       int num, int denom, TreatmentId treatment_id, int width)
 {
-  CCCC_Metric m(num,denom, tag.c_str());
+  CCCC_Metric m(num,denom, treatment_id);
   Put_Metric_Cell(m, width);
 }
 
@@ -945,13 +988,8 @@ void  CCCC_Html_Stream::Put_Metric_Cell(const CCCC_Metric& metric, int width)
 
 void CCCC_Html_Stream::Put_Extent_URL(const CCCC_Extent& extent)
 {
-  string filename=extent.name(nlFILENAME);
-  int linenumber=atoi(extent.name(nlLINENUMBER).c_str());
-
-  Source_Anchor anchor(filename, linenumber);
-  string key=anchor.key();
-  source_anchor_map_t::value_type anchor_value(key, anchor);
-  source_anchor_map.insert(anchor_value);
+  Source_Anchor anchor(extent.get_filename(), extent.get_linenumber());
+  source_anchor_set.insert(anchor);
 
   anchor.Emit_HREF(fstr);
   fstr
@@ -970,15 +1008,16 @@ void CCCC_Html_Stream::Put_Extent_Cell(const CCCC_Extent& extent, int width, boo
 
 void CCCC_Html_Stream::Put_Extent_List(CCCC_Record& record, bool withDescription)
 {
-  CCCC_Extent *ext_ptr=record.extent_table.first_item();
-  while(ext_ptr!=NULL)
+  CCCC_Record::Extent_Table::iterator extIter=record.extent_table.begin();
+  while(extIter!=record.extent_table.end())
     {
+      CCCC_Extent *ext_ptr=&*extIter;
       if(withDescription)
       {
           fstr << ext_ptr->name(nlDESCRIPTION) << " &nbsp;" << endl;
       }
       Put_Extent_URL(*ext_ptr);
-      ext_ptr=record.extent_table.next_item();
+      extIter++;
     }
   fstr << _HTMLLineBreak << endl;
 }
@@ -1002,82 +1041,131 @@ CCCC_Html_Stream& operator <<(CCCC_Html_Stream& os, const CCCC_Metric& mtc)
   return os;
 }
 
-void CCCC_Html_Stream::Separate_Modules()
+void CCCC_Html_Stream::Separate_Modules(int threads, 
+					CCCC_PageManifest *manifest)
 {
   // this function generates a separate HTML report for each non-trivial
   // module in the database
-
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
-  while(mod_ptr!=NULL)
+  // The reports are independent of one another, so they are shared out
+  // among a number of threads, each of which takes the next module on 
+  // the list until none are left.
+  std::vector<CCCC_Module*> modules;
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       int trivial_module=mod_ptr->is_trivial();
       if(trivial_module==FALSE)
 	{
-	  string info="Detailed report on module " + mod_ptr->key();
-	  string filename=outdir;
-	  filename+="/";
-	  filename+=mod_ptr->key()+".html";
-	  CCCC_Html_Stream module_html_str(filename,info.c_str());
-
-	  module_html_str.Put_Section_Heading(info.c_str(),"summary",1);
-
-	  module_html_str.Module_Summary(mod_ptr);
-
-	  module_html_str.Put_Section_Heading("Definitions and Declarations",
-										  "modext",2);
-	  module_html_str.fstr << HTMLBeginElement(_Table, "summary")
-			  	  	  	   << HTMLBeginElement(_TableHead)
-						   << HTMLBeginElement(_TableRow) << endl;
-	  module_html_str.Put_Label_Cell("Description",50);
-	  module_html_str.Put_Header_Cell("LOC",10);
-	  module_html_str.Put_Header_Cell("MVG",10);
-	  module_html_str.Put_Header_Cell("COM",10);
-	  module_html_str.Put_Header_Cell("L_C",10);
-	  module_html_str.Put_Header_Cell("M_C",10);
-	  module_html_str.fstr
-	  	  	  << HTMLEndElement(_TableRow)
-			  << HTMLEndElement(_TableHead);
-	  module_html_str.Module_Detail(mod_ptr);
-	  module_html_str.fstr << HTMLEndElement(_Table);
-
-	  module_html_str.Put_Section_Heading("Functions","proc",2);
-	  module_html_str.fstr << HTMLBeginElement(_Table, "summary")
-	  	  	  	  	  	   << HTMLBeginElement(_TableHead)
-						   << HTMLBeginElement(_TableRow) << endl;
-	  module_html_str.Put_Label_Cell("Function prototype",50);
-	  module_html_str.Put_Header_Cell("LOC",10);
-	  module_html_str.Put_Header_Cell("MVG",10);
-	  module_html_str.Put_Header_Cell("COM",10);
-	  module_html_str.Put_Header_Cell("L_C",10);
-	  module_html_str.Put_Header_Cell("M_C",10);
-	  module_html_str.fstr << HTMLEndElement(_TableRow)
-						   << HTMLEndElement(_TableHead) << endl;
-	  module_html_str.Procedural_Detail(mod_ptr);
-	  module_html_str.fstr << HTMLEndElement(_Table);
-
-	  module_html_str.Put_Section_Heading("Relationships","structdet",2);
-	  module_html_str.fstr << HTMLBeginElement(_Table, "summary")
-			  << HTMLBeginElement(_TableHead)
-			  << HTMLBeginElement(_TableRow)
-			  << HTMLBeginElement(_TableHeader, "", 50) << "Clients" << HTMLEndElement(_TableHeader)
-			  << HTMLBeginElement(_TableHeader, "", 50) << "Suppliers" << HTMLEndElement(_TableHeader)
-			  << HTMLEndElement(_TableRow) << endl
-			  << HTMLEndElement(_TableHead) << endl
-			  << HTMLBeginElement(_TableRow) << endl;
-	  module_html_str.Structural_Detail(mod_ptr);
-	  module_html_str.fstr << HTMLEndElement(_TableRow) << HTMLEndElement(_Table) << endl;
-
-
+	  modules.push_back(mod_ptr);
 	}
       else
 	{
 #if 0
-	  cerr << mod_ptr->module_type << " " << mod_ptr->key()
+	  cerr << mod_ptr->name(nlMODULE_TYPE) << " " << mod_ptr->key()
 	       << " is trivial" << endl;
 #endif
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
+
+  std::mutex modules_mutex;
+  size_t next_module=0;
+  auto write_reports=[&]()
+    {
+      for(;;)
+	{
+	  CCCC_Module *mod_ptr;
+	  {
+	    std::lock_guard<std::mutex> lock(modules_mutex);
+	    if(next_module==modules.size())
+	      {
+		break;
+	      }
+	    mod_ptr=modules[next_module++];
+	  }
+	  Separate_Module(mod_ptr,manifest);
+	}
+    };
+
+  // this thread does its share too
+  std::vector<std::thread> writers;
+  for(int i=1; i<threads && static_cast<size_t>(i)<modules.size(); i++)
+    {
+      writers.push_back(std::thread(write_reports));
+    }
+  write_reports();
+  for(size_t i=0; i<writers.size(); i++)
+    {
+      writers[i].join();
+    }
+}
+
+void CCCC_Html_Stream::Separate_Module(CCCC_Module *mod_ptr, 
+				       CCCC_PageManifest *manifest)
+{
+  // this function generates the separate HTML report for one module
+  // the source lines it refers to are passed back to this stream for 
+  // the source listing
+  string info="Detailed report on module " + mod_ptr->key();
+  string filename=outdir;
+  filename+="/";
+  filename+=mod_ptr->key()+".html";
+  CCCC_Html_Stream module_html_str(filename,info.c_str(),prjptr,outdir,
+				  manifest);
+
+  module_html_str.Put_Section_Heading(info.c_str(),"summary",1);
+
+  module_html_str.Module_Summary(mod_ptr);
+
+  module_html_str.Put_Section_Heading("Definitions and Declarations",
+  									  "modext",2);
+  module_html_str.fstr << HTMLBeginElement(_Table, "summary")
+  		  	  	  	   << HTMLBeginElement(_TableHead)
+  					   << HTMLBeginElement(_TableRow) << endl;
+  module_html_str.Put_Label_Cell("Description",50);
+  module_html_str.Put_Header_Cell("LOC",10);
+  module_html_str.Put_Header_Cell("MVG",10);
+  module_html_str.Put_Header_Cell("COM",10);
+  module_html_str.Put_Header_Cell("L_C",10);
+  module_html_str.Put_Header_Cell("M_C",10);
+  module_html_str.fstr
+  	  	  << HTMLEndElement(_TableRow)
+  		  << HTMLEndElement(_TableHead);
+  module_html_str.Module_Detail(mod_ptr);
+  module_html_str.fstr << HTMLEndElement(_Table);
+
+  module_html_str.Put_Section_Heading("Functions","proc",2);
+  module_html_str.fstr << HTMLBeginElement(_Table, "summary")
+  	  	  	  	  	   << HTMLBeginElement(_TableHead)
+  					   << HTMLBeginElement(_TableRow) << endl;
+  module_html_str.Put_Label_Cell("Function prototype",50);
+  module_html_str.Put_Header_Cell("LOC",10);
+  module_html_str.Put_Header_Cell("MVG",10);
+  module_html_str.Put_Header_Cell("COM",10);
+  module_html_str.Put_Header_Cell("L_C",10);
+  module_html_str.Put_Header_Cell("M_C",10);
+  module_html_str.fstr << HTMLEndElement(_TableRow)
+  					   << HTMLEndElement(_TableHead) << endl;
+  module_html_str.Procedural_Detail(mod_ptr);
+  module_html_str.fstr << HTMLEndElement(_Table);
+
+  module_html_str.Put_Section_Heading("Relationships","structdet",2);
+  module_html_str.fstr << HTMLBeginElement(_Table, "summary")
+  		  << HTMLBeginElement(_TableHead)
+  		  << HTMLBeginElement(_TableRow)
+  		  << HTMLBeginElement(_TableHeader, "", 50) << "Clients" << HTMLEndElement(_TableHeader)
+  		  << HTMLBeginElement(_TableHeader, "", 50) << "Suppliers" << HTMLEndElement(_TableHeader)
+  		  << HTMLEndElement(_TableRow) << endl
+  		  << HTMLEndElement(_TableHead) << endl
+  		  << HTMLBeginElement(_TableRow) << endl;
+  module_html_str.Structural_Detail(mod_ptr);
+  module_html_str.fstr << HTMLEndElement(_TableRow) << HTMLEndElement(_Table) << endl;
+
+  static std::mutex anchor_mutex;
+  std::lock_guard<std::mutex> lock(anchor_mutex);
+  source_anchor_set.insert(module_html_str.source_anchor_set.begin(),
+			   module_html_str.source_anchor_set.end());
 }
 
 void CCCC_Html_Stream::Module_Detail(CCCC_Module *module_ptr)
@@ -1102,18 +1190,18 @@ void CCCC_Html_Stream::Module_Detail(CCCC_Module *module_ptr)
     {
       while(eIter!=module_ptr->extent_table.end())
 	{
-	  CCCC_Extent *ext_ptr=(*eIter).second;
+	  CCCC_Extent *ext_ptr=&*eIter;
 	  fstr << HTMLBeginElement(_TableRow) << endl;
 	  Put_Extent_Cell(*ext_ptr,0,true);
-	  int loc=ext_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-	  int mvg=ext_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-	  int com=ext_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
+	  int loc=ext_ptr->get_count(miLOC);
+	  int mvg=ext_ptr->get_count(miMVG);
+	  int com=ext_ptr->get_count(miCOM);
 
-	  Put_Metric_Cell(CCCC_Metric(loc, "LOCf"));
-	  Put_Metric_Cell(CCCC_Metric(mvg, "MVGf"));
+	  Put_Metric_Cell(CCCC_Metric(loc, tmLOCf));
+	  Put_Metric_Cell(CCCC_Metric(mvg, tmMVGf));
 	  Put_Metric_Cell(com);
-	  Put_Metric_Cell(CCCC_Metric(loc, com, "L_C"));
-	  Put_Metric_Cell(CCCC_Metric(mvg, com, "M_C"));
+	  Put_Metric_Cell(CCCC_Metric(loc, com, tmL_C));
+	  Put_Metric_Cell(CCCC_Metric(mvg, com, tmM_C));
 	  fstr << HTMLEndElement(_TableRow) << endl;
 
 	  eIter++;
@@ -1134,26 +1222,26 @@ void CCCC_Html_Stream::Procedural_Detail(CCCC_Module *module_ptr)
   // 2. within the Procedural_Detail function, where the table tags are
   //    around the output of many calls to this function
 
-  CCCC_Module::member_map_t::iterator iter = module_ptr->member_map.begin();
+  CCCC_Module::member_list_t::iterator iter = module_ptr->member_list.begin();
 
-  if(iter==module_ptr->member_map.end())
+  if(iter==module_ptr->member_list.end())
       fstr << HTMLSingleEntryRow(6, "No member functions have been identified for this module") << endl;
   else
     {
-      while(iter!=module_ptr->member_map.end())
+      while(iter!=module_ptr->member_list.end())
 	{
-	  CCCC_Member *mem_ptr=(*iter).second;
+	  CCCC_Member *mem_ptr=*iter;
 	  fstr << HTMLBeginElement(_TableRow) << endl;
 	  Put_Label_Cell(mem_ptr->name(nlLOCAL).c_str(),0,"","",mem_ptr);
-	  int loc=mem_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-	  int mvg=mem_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-	  int com=mem_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
+	  int loc=mem_ptr->get_count(miLOC);
+	  int mvg=mem_ptr->get_count(miMVG);
+	  int com=mem_ptr->get_count(miCOM);
 
-	  Put_Metric_Cell(CCCC_Metric(loc, "LOCf"));
-	  Put_Metric_Cell(CCCC_Metric(mvg, "MVGf"));
+	  Put_Metric_Cell(CCCC_Metric(loc, tmLOCf));
+	  Put_Metric_Cell(CCCC_Metric(mvg, tmMVGf));
 	  Put_Metric_Cell(com);
-	  Put_Metric_Cell(CCCC_Metric(loc, com, "L_C"));
-	  Put_Metric_Cell(CCCC_Metric(mvg, com, "M_C"));
+	  Put_Metric_Cell(CCCC_Metric(loc, com, tmL_C));
+	  Put_Metric_Cell(CCCC_Metric(mvg, com, tmM_C));
 	  fstr << HTMLEndElement(_TableRow) << endl;
 
 	  iter++;
@@ -1186,20 +1274,20 @@ void CCCC_Html_Stream::Module_Summary(CCCC_Module *module_ptr)
   // calculate the counts on which all displayed data will be based
   // int nof=module_ptr->member_table.records(); // Number of functions
   int nof=0;
-  int loc=module_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-  int mvg=module_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-  int com=module_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
+  int loc=module_ptr->get_count(miLOC);
+  int mvg=module_ptr->get_count(miMVG);
+  int com=module_ptr->get_count(miCOM);
 
   // the variants of IF4 measure information flow and couplings
-  int if4=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4);
-  int if4v=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX);
-  int if4c=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX);
+  int if4=module_ptr->get_count(miIF4);
+  int if4v=module_ptr->get_count(miIF4v);
+  int if4c=module_ptr->get_count(miIF4c);
 
-  int wmc1=module_ptr->get_count(COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY);
-  int wmcv=module_ptr->get_count(COUNT_TAG_WEIGHTED_METHODS_PER_CLASS COUNT_TAG_VISIBLE_SUFFIX);
-  int dit=module_ptr->get_count(COUNT_TAG_INHERITANCE_TREE_DEPTH);
-  int noc=module_ptr->get_count(COUNT_TAG_NUMBER_OF_CHILDREN);
-  int cbo=module_ptr->get_count(COUNT_TAG_COUPLING_BETWEEN_OBJECTS);
+  int wmc1=module_ptr->get_count(miWMC1);
+  int wmcv=module_ptr->get_count(miWMCv);
+  int dit=module_ptr->get_count(miDIT);
+  int noc=module_ptr->get_count(miNOC);
+  int cbo=module_ptr->get_count(miCBO);
 
   fstr << HTMLBeginElement(_Table, "summary");
 
@@ -1215,35 +1303,35 @@ void CCCC_Html_Stream::Module_Summary(CCCC_Module *module_ptr)
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("Lines of Code");
   Put_Label_Cell("LOC");
-  Put_Metric_Cell(loc,"LOCm");
-  Put_Metric_Cell(loc,nof,"LOCg");
+  Put_Metric_Cell(loc,tmLOCm);
+  Put_Metric_Cell(loc,nof,tmLOCg);
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("McCabe's Cyclomatic Number");
   Put_Label_Cell("MVG");
-  Put_Metric_Cell(mvg,"MVGm");
-  Put_Metric_Cell(mvg,nof,"MVGf");
+  Put_Metric_Cell(mvg,tmMVGm);
+  Put_Metric_Cell(mvg,nof,tmMVGf);
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("Lines of Comment");
   Put_Label_Cell("COM");
-  Put_Metric_Cell(com,"COMm");
-  Put_Metric_Cell(com,nof,"8.3");
+  Put_Metric_Cell(com,tmCOMm);
+  Put_Metric_Cell(com,nof,tm8_3);
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("LOC/COM");
   Put_Label_Cell("L_C");
-  Put_Metric_Cell(loc,com,"L_C");
+  Put_Metric_Cell(loc,com,tmL_C);
   fstr << HTMLTableCell("&nbsp;");
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("MVG/COM");
   Put_Label_Cell("M_C");
-  Put_Metric_Cell(mvg,com,"M_C");
+  Put_Metric_Cell(mvg,com,tmM_C);
   fstr << HTMLTableCell("&nbsp;");
   fstr << HTMLEndElement(_TableRow);
 
@@ -1285,32 +1373,45 @@ void CCCC_Html_Stream::Module_Summary(CCCC_Module *module_ptr)
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("Information Flow measure (inclusive)");
   Put_Label_Cell("IF4");
-  Put_Metric_Cell(if4,1,"IF4");
-  Put_Metric_Cell(if4,nof,"8.3");
+  Put_Metric_Cell(if4,1,tmIF4);
+  Put_Metric_Cell(if4,nof,tm8_3);
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("Information Flow measure (visible)");
   Put_Label_Cell("IF4v");
-  Put_Metric_Cell(if4v,1,"IF4v");
-  Put_Metric_Cell(if4v,nof,"8.3");
+  Put_Metric_Cell(if4v,1,tmIF4v);
+  Put_Metric_Cell(if4v,nof,tm8_3);
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLBeginElement(_TableRow);
   Put_Label_Cell("Information Flow measure (concrete)");
   Put_Label_Cell("IF4c");
-  Put_Metric_Cell(if4c,1,"IF4c");
-  Put_Metric_Cell(if4c,nof,"8.3");
+  Put_Metric_Cell(if4c,1,tmIF4c);
+  Put_Metric_Cell(if4c,nof,tm8_3);
   fstr << HTMLEndElement(_TableRow);
 
   fstr << HTMLEndElement(_Table);
 }
 
 
-CCCC_Html_Stream::CCCC_Html_Stream(const string& fname, const string& info)
+CCCC_Html_Stream::CCCC_Html_Stream(const string& fname, const string& info,
+				   CCCC_Project* project, const string& dir,
+				   CCCC_PageManifest *manifest)
+: page_filename(fname)
+, page_manifest(manifest)
+, outdir(dir)
+, prjptr(project)
 {
   // cerr << "Attempting to open file in directory " << outdir.c_str() << endl;
-  fstr.open(fname.c_str());
+  if(page_manifest!=NULL)
+    {
+      fstr.basic_ios<char>::rdbuf(&page_buffer);
+    }
+  else
+    {
+      fstr.open(fname.c_str());
+    }
   if(fstr.good() != TRUE)
     {
       cerr << "failed to open " << fname.c_str()
@@ -1329,23 +1430,6 @@ CCCC_Html_Stream::CCCC_Html_Stream(const string& fname, const string& info)
   PopulateJSTooltipMap();
 }
 
-int setup_anchor_data()
-{
-  int i=0;
-  Source_Anchor a1("cccc_use.h",12);
-  Source_Anchor a2("cccc_htm.h",15);
-  i++;
-  string key1=a1.key(), key2=a2.key();
-  i++;
-  source_anchor_map_t::value_type v1(key1,a1);
-  source_anchor_map_t::value_type v2(key2,a2);
-  i++;
-  source_anchor_map.insert(v1);
-  source_anchor_map.insert(v2);
-  return i;
-}
-
-
 void CCCC_Html_Stream::Source_Listing()
 {
   // The variable stream src_str used to be an instance
@@ -1353,28 +1437,33 @@ void CCCC_Html_Stream::Source_Listing()
   // this worked under Linux but broke under Win32, so
   // this variable is now a pointer which is repeatedly
   // deleted and new'ed
+  // The text of each file is read in the same way as it was for 
+  // the parser, as it may have come from a git revision.
 
   string current_filename;
   int current_line=0;
   int next_anchor_required=0;
-  ifstream *src_str=NULL;
+  std::istringstream *src_str=NULL;
   string style_open = HTMLBeginElement(_Div, "code"), style_close = HTMLEndElement(_Div);
 
   string filename=outdir;
   filename+="/cccc_src.html";
-  CCCC_Html_Stream source_html_str(filename.c_str(),"source file");
+  CCCC_Html_Stream source_html_str(filename.c_str(),"source file",
+				   prjptr,outdir);
 
-  source_anchor_map_t::iterator iter=source_anchor_map.begin();
-  while(iter!=source_anchor_map.end())
+  source_anchor_set_t::iterator iter=source_anchor_set.begin();
+  while(iter!=source_anchor_set.end())
     {
       char linebuf[1024];
-      Source_Anchor& nextAnchor=(*iter).second;
+      const Source_Anchor& nextAnchor=*iter;
       if(current_filename!=nextAnchor.get_file())
 	{
 	  current_filename=nextAnchor.get_file();
 	  current_line=0;
 	  delete src_str;
-	  src_str=new ifstream(current_filename.c_str(),std::ios::in);
+	  string source_text;
+	  CCCC_SourceBuffer::ReadFile(current_filename,source_text);
+	  src_str=new std::istringstream(source_text);
 	  src_str->getline(linebuf,1023);
 	  source_html_str.Put_Section_Heading(current_filename.c_str(), current_filename.c_str(), 1);
 	}
@@ -1384,17 +1473,17 @@ void CCCC_Html_Stream::Source_Listing()
 	  current_line++;
           source_html_str.fstr << style_open;
 	  if(
-	     (iter!=source_anchor_map.end()) &&
-	     (current_filename==(*iter).second.get_file()) &&
-	     (current_line==(*iter).second.get_line())
+	     (iter!=source_anchor_set.end()) &&
+	     (current_filename==iter->get_file()) &&
+	     (current_line==iter->get_line())
 	     )
 	    {
-	      (*iter).second.Emit_NAME(source_html_str.fstr);
+	      iter->Emit_NAME(source_html_str.fstr);
 	      iter++;
 	    }
 	  else
 	    {
-	      (*iter).second.Emit_SPACE(source_html_str.fstr);
+	      iter->Emit_SPACE(source_html_str.fstr);
 	    }
  	  source_html_str << linebuf;
  	  source_html_str.fstr << endl;
@@ -1406,12 +1495,12 @@ void CCCC_Html_Stream::Source_Listing()
       // by line number must be wrong
       // complain and ignore
       while(
-	    (iter!=source_anchor_map.end()) &&
-	    (current_filename==(*iter).second.get_file())
+	    (iter!=source_anchor_set.end()) &&
+	    (current_filename==iter->get_file())
 	    )
 	{
           source_html_str.fstr << style_open;
-	  (*iter).second.Emit_NAME(source_html_str.fstr);
+	  iter->Emit_NAME(source_html_str.fstr);
           source_html_str.fstr << style_close;
 	  iter++;
 	}
@@ -1441,20 +1530,57 @@ string Source_Anchor::key() const
 {
   char linebuf[16];
   snprintf(linebuf, sizeof(linebuf), "%08d", line_);
-  return file_ + ":" + linebuf;
+  return get_file() + ":" + linebuf;
 }
 
+bool Source_Anchor::operator<(const Source_Anchor& other) const
+{
+  // The line numbers in the keys are padded to the same width, so the
+  // keys of anchors in the same file sort as their line numbers do, and
+  // those of anchors in different files as the filenames do up to the
+  // first character where they differ, counting the ':' which ends each.
+  // Only when the ':' ending one name meets a ':' in the other is there
+  // any need to look at the keys themselves.
+  bool retval;
+  if(file_==other.file_)
+    {
+      retval=line_<other.line_;
+    }
+  else
+    {
+      const string& file1=get_file();
+      const string& file2=other.get_file();
+      size_t common=std::min(file1.size(),file2.size());
+      int comparison=file1.compare(0,common,file2,0,common);
+      unsigned char next1= common<file1.size() ? file1[common] : ':';
+      unsigned char next2= common<file2.size() ? file2[common] : ':';
+      if(comparison!=0)
+	{
+	  retval=comparison<0;
+	}
+      else if(next1!=next2)
+	{
+	  retval=next1<next2;
+	}
+      else
+	{
+	  retval=key()<other.key();
+	}
+    }
+  return retval;
+}
 
-void Source_Anchor::Emit_HREF(ofstream& fstr)
+
+void Source_Anchor::Emit_HREF(ofstream& fstr) const
 {
   string anchor_key=key();
 
   fstr << "<a class=\"sourceAnchor\" href=\"cccc_src.html#" << anchor_key.c_str() << "\">"
-       << file_.c_str() << ":" << line_
+       << get_file().c_str() << ":" << line_
        << "</a>";
 }
 
-void Source_Anchor::Emit_NAME(ofstream& fstr)
+void Source_Anchor::Emit_NAME(ofstream& fstr) const
 {
   string anchor_key=key();
   char ln_buf[32];
@@ -1465,7 +1591,7 @@ void Source_Anchor::Emit_NAME(ofstream& fstr)
        << ln_string.c_str() << space_string.c_str();
 }
 
-void Source_Anchor::Emit_SPACE(ofstream& fstr)
+void Source_Anchor::Emit_SPACE(ofstream& fstr) const
 {
   string space_string=pad_string(10, "", " ");
   fstr << space_string.c_str();
@@ -1572,16 +1698,19 @@ string CCCC_Html_Stream::HTMLEscapeLiteral(const char* inp)
 
 void CCCC_Html_Stream::PopulateJSTooltipMap()
 {
-    const metric_description_t* ptrs[] = { &ProjectSummaryMetrics[0], &OODesignMetrics[0], &StructuralSummaryMetrics[0] };
-    int counts[] = { COUNTOF(ProjectSummaryMetrics), COUNTOF(OODesignMetrics), COUNTOF(StructuralSummaryMetrics) };
+    std::vector<metric_description_t> entries;
+    for (int k = 0; k < COUNTOF(ProjectSummaryMetrics); ++k)
+        entries.push_back(describe_metric(ProjectSummaryMetrics[k]));
+    for (int k = 0; k < COUNTOF(OODesignMetrics); ++k)
+        entries.push_back(describe_metric(OODesignMetrics[k]));
+    for (int k = 0; k < COUNTOF(StructuralSummaryMetrics); ++k)
+        entries.push_back(StructuralSummaryMetrics[k]);
     fstr << "<script type=\"text/javascript\">";
-    for (int k = 0; k < COUNTOF(ptrs); ++k) {
-        for (int j = 0; j < counts[k]; ++j)
-            fstr << "  window.g_Glossary['"
-                 << JSEscapeStringLiteral(ptrs[k][j].abbreviation) << "'] = {"
-                    "  name: '" << JSEscapeStringLiteral((strlen(ptrs[k][j].name) == 0) ? ptrs[k][j].abbreviation : ptrs[k][j].name) << "', "
-                    "  description: '" << JSEscapeStringLiteral(ptrs[k][j].description) << "' };\n";
-    }
+    for (size_t j = 0; j < entries.size(); ++j)
+        fstr << "  window.g_Glossary['"
+             << JSEscapeStringLiteral(entries[j].abbreviation) << "'] = {"
+                "  name: '" << JSEscapeStringLiteral((strlen(entries[j].name) == 0) ? entries[j].abbreviation : entries[j].name) << "', "
+                "  description: '" << JSEscapeStringLiteral(entries[j].description) << "' };\n";
     fstr << "</script>" << endl;
 }
 
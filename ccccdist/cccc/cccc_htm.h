@@ -22,6 +22,9 @@
 #include "cccc.h"
 
 #include <fstream>
+#include <sstream>
+#include <mutex>
+#include <set>
 
 #include <time.h>
 
@@ -41,6 +44,63 @@ enum ReportType {
 };
 
 
+// this class is added to support the generation of an HTML file
+// containing the source analysed by the run, with anchors embedded at
+// each of the lines referred to in the other parts of the report
+class Source_Anchor
+{
+  // if this looks more like a struct to you, it does to me too...
+  // it could be embedded withing CCCC_Html_Stream except that this
+  // might make the default constructor unavailable for the std::set
+  // instantiation
+
+  Symbol file_;
+  int line_;
+ public:
+  Source_Anchor():file_(SymbolTable::EMPTY), line_(0) {}
+  Source_Anchor(Symbol file, int line) : file_(file), line_(line) {}
+
+  const string& get_file() const { return SymbolTable::text(file_); }
+  int get_line() const { return line_; }
+  string key() const;
+
+  // anchors sort in the order of their keys
+  bool operator<(const Source_Anchor& other) const;
+
+  void Emit_HREF(ofstream& fstr) const;
+  void Emit_NAME(ofstream& fstr) const;
+  void Emit_SPACE(ofstream& fstr) const;
+  // the default copy constructor, assignment operator and destructor
+  // are OK for this class
+};
+
+typedef std::set<Source_Anchor> source_anchor_set_t;
+
+// CCCC_PageManifest keeps a hash of the content of each separate page 
+// written to an output directory, in a file in the same directory, so 
+// that a page whose content has not changed since the last run can be 
+// left alone rather than written again.  It is shared by the HTML and 
+// XML reports, and by the threads writing them.
+class CCCC_PageManifest
+{
+  string directory;
+  string manifest_filename;
+
+  // the pages are recorded by their names within the directory
+  std::map<string,string> page_hashes;
+  string PageName(const string& page_filename) const;
+  std::mutex manifest_mutex;
+
+ public:
+  CCCC_PageManifest(const string& outdir);
+
+  // writes the page unless the last run left it with the same content,
+  // returning true if it was written
+  bool Write(const string& page_filename, const string& content);
+  void Save();
+};
+
+
 class CCCC_Html_Stream {
   friend CCCC_Html_Stream& operator <<(CCCC_Html_Stream& os,
 				       const string& stg);
@@ -63,9 +123,16 @@ class CCCC_Html_Stream {
   static const char* _UnorderedList;
 
   ofstream fstr;
+  std::stringbuf page_buffer;
+  string page_filename;
+  CCCC_PageManifest *page_manifest;
   static string libdir;
-  static string outdir;
-  static CCCC_Project* prjptr;
+  string outdir;
+  CCCC_Project* prjptr;
+
+  // the source lines referred to by this stream, which are listed with
+  // anchors in the source report
+  source_anchor_set_t source_anchor_set;
   static string HTMLEscapeLiteral(const char* inp);
   static string JSEscapeStringLiteral(const char* inp);
   static string HTMLBeginElement(const char* nam, const char* clas = "", int width = -1);
@@ -83,7 +150,8 @@ class CCCC_Html_Stream {
   void Structural_Detail();
   void OO_Design();
   void Other_Extents();
-  void Separate_Modules();
+  void Separate_Modules(int threads, CCCC_PageManifest *manifest);
+  void Separate_Module(CCCC_Module *module_ptr, CCCC_PageManifest *manifest);
   void Source_Listing();
   void PopulateJSTooltipMap();
 
@@ -106,8 +174,8 @@ class CCCC_Html_Stream {
 		      CCCC_Record *rec_ptr=0);
   void Put_Empty_Cell(int width = -1);
   void Put_Metric_Cell(const CCCC_Metric& metric, int width=-1);
-  void Put_Metric_Cell(int count, string tag, int width=-1);
-  void Put_Metric_Cell(int num, int denom, string tag, int width=-1);
+  void Put_Metric_Cell(int count, TreatmentId treatment_id, int width=-1);
+  void Put_Metric_Cell(int num, int denom, TreatmentId treatment_id, int width=-1);
   void Put_Extent_URL(const CCCC_Extent& extent);
   void Put_Extent_Cell(const CCCC_Extent& extent, int width=-1, bool withDescription=false);
   void Put_Extent_List(CCCC_Record& record,bool withDescription=false);
@@ -121,11 +189,19 @@ class CCCC_Html_Stream {
 			  string description);
 
  public:
+  // the separate module reports are shared out among the given number 
+  // of threads
   static void GenerateReports(CCCC_Project* project, int report_mask,
-			      const string& outfile, const string& outdir);
+			      const string& outfile, const string& outdir,
+			      int threads=1, 
+			      CCCC_PageManifest *manifest=NULL);
 
   // general-purpose constructor with standard preamble
-  CCCC_Html_Stream(const string& fname, const string& info);
+  // if a manifest is given, the page is gathered in memory and written 
+  // through the manifest by the destructor
+  CCCC_Html_Stream(const string& fname, const string& info,
+		   CCCC_Project* project, const string& dir,
+		   CCCC_PageManifest *manifest=NULL);
 
   // destructor with standard trailer
   ~CCCC_Html_Stream();
@@ -135,33 +211,6 @@ CCCC_Html_Stream& operator <<(CCCC_Html_Stream& os, const string& stg);
 CCCC_Html_Stream& operator <<(CCCC_Html_Stream& os, const CCCC_Metric& mtc);
 CCCC_Html_Stream& operator <<(CCCC_Html_Stream& os, const CCCC_Extent& ext);
 
-// this class is added to support the generation of an HTML file
-// containing the source analysed by the run, with anchors embedded at
-// each of the lines referred to in the other parts of the report
-class Source_Anchor
-{
-  // if this looks more like a struct to you, it does to me too...
-  // it could be embedded withing CCCC_Html_Stream except that this
-  // might make the default constructor unavailable for the std::map
-  // instantiation
-
-  string file_;
-  int line_;
- public:
-  Source_Anchor():line_(0) {}
-  Source_Anchor(string file, int line) : file_(file), line_(line) {}
-
-  string get_file() const { return file_; }
-  int get_line() const { return line_; }
-  string key() const;
-
-  void Emit_HREF(ofstream& fstr);
-  void Emit_NAME(ofstream& fstr);
-  void Emit_SPACE(ofstream& fstr);
-  // the default copy constructor, assignment operator and destructor
-  // are OK for this class
-};
-
 #endif /* __CCCC_HTM_H */
 
 
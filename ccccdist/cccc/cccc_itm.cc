@@ -76,6 +76,17 @@ bool CCCC_Item::Extract(int& n)
   return retval;
 }
 
+bool CCCC_Item::Extract(Symbol& symbol)
+{
+  string text;
+  bool retval=Extract(text);
+  if(retval)
+    {
+      symbol=SymbolTable::intern(text);
+    }
+  return retval;
+}
+
 bool CCCC_Item::Insert(char c)
 {
   char charbuf[2];
@@ -119,10 +130,8 @@ bool CCCC_Item::ToFile(ofstream& ofstr)
 bool CCCC_Item::FromFile(ifstream& ifstr)
 {
   good=false;
-  char line_buffer[1024];
-  ifstr.getline(line_buffer,1023);
-  buffer=line_buffer;
-  if(ifstr.good() && buffer.size()>0 && buffer.size()<1023)
+  std::getline(ifstr,buffer);
+  if(ifstr.good() && buffer.size()>0)
     {
       delimiter=buffer[buffer.size()-1];
       good=true;
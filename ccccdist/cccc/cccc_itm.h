@@ -3,6 +3,7 @@
 #define __CCCC_ITM_H
 
 #include "cccc.h"
+#include "cccc_sym.h"
 
 // Class CCCC_Item is a wrapper for a C++ standard string which allows
 // insertion and extraction of fields using a standard delimiter.
@@ -34,8 +35,14 @@ public:
   bool Insert(float f);
   bool Extract(float& f);
 
+  // extracts a field as the symbol of its text
+  bool Extract(Symbol& symbol);
+
   bool ToFile(ofstream& ofstr);
   bool FromFile(ifstream& ifstr);
+
+  // the fields which have not yet been extracted, with their delimiters
+  const string& Text() const { return buffer; }
 };
 
 #endif
@@ -0,0 +1,321 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+/*
+ * cccc_mdf.h
+ *
+ * the definitions of the metrics counted by CCCC, and of the treatments
+ * used to display them
+ */
+#ifndef CCCC_MDF_H
+#define CCCC_MDF_H
+
+#define COUNT_TAG_NUMBER_OF_MODULES                     "NOM"
+#define COUNT_TAG_LINES_OF_CODE                         "LOC"
+#define COUNT_TAG_CYCLOMATIC_NUMBER                     "MVG"
+#define COUNT_TAG_LINES_OF_COMMENT                      "COM"
+#define COUNT_TAG_INTERMODULE_COMPLEXITY4               "IF4" // may take VISIBLE, CONCRETE suffixes
+#define COUNT_TAG_VISIBLE_SUFFIX                        "v"
+#define COUNT_TAG_CONCRETE_SUFFIX                       "c"
+
+#define COUNT_TAG_COUPLING_BETWEEN_OBJECTS              "CBO"
+#define COUNT_TAG_NUMBER_OF_CHILDREN                    "NOC"
+#define COUNT_TAG_INHERITANCE_TREE_DEPTH                "DIT"
+#define COUNT_TAG_FAN_IN                                "FI"
+#define COUNT_TAG_FAN_OUT                               "FO"
+#define COUNT_TAG_WEIGHTED_METHODS_PER_CLASS            "WMC"   // may take VISIBLE suffix
+#define COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY      "WMC1"
+
+#define COUNT_TAG_MAX_LINES_OF_CODE_PER_METHOD          "MLOCpM" // must be used at module get_count level - doesn't make sense to sum
+
+// Each count kept by the database is requested by a MetricId, which
+// indexes the table of definitions below, so that no tag has to be
+// compared to work a count out.  The variants of a count which take a
+// suffix follow the overall count directly.  The ratios at the end
+// are not counted, but are described in the reports.
+enum MetricId
+{
+  miNOM, miLOC, miMVG, miCOM,
+  miIF4, miIF4v, miIF4c,
+  miFI, miFIv, miFIc,
+  miFO, miFOv, miFOc,
+  miWMC1, miWMCv,
+  miDIT, miNOC, miCBO,
+  miMLOCpM,
+  miL_C, miM_C, miLOCpM,
+  miLAST
+};
+
+// Each value displayed is formatted, and its emphasis decided, by the
+// treatment with the given TreatmentId.  The options file names the
+// treatments by code, and may change their thresholds or give one to
+// a code which has no default treatment.
+enum TreatmentId
+{
+  tmNONE=-1,
+  tmLOCf, tmLOCm, tmLOCper, tmLOCp, tmLOCg, tmLOC,
+  tmMVGf, tmMVGm, tmMVGper, tmMVGp, tmMVG,
+  tmCOM, tmCOMm, tmCOMper,
+  tmM_C, tmL_C,
+  tmFI, tmFIv, tmFIc,
+  tmFO, tmFOv, tmFOc,
+  tmIF4, tmIF4v, tmIF4c,
+  tmWMC1, tmWMCv,
+  tmDIT, tmNOC, tmCBO,
+  tm8_3, tmREJ,
+  tmLAST
+};
+
+struct MetricDefinition
+{
+  MetricId id;
+  const char *tag;
+  MetricId base;         // the overall count of which this is a variant
+  char suffix;           // the suffix of the variant, or '\0'
+  TreatmentId treatment;
+  const char *name;
+  const char *description;
+};
+
+#define _WMC_NAME_START "Weighted methods per class"
+#define _WMC_DESCRIPTION_START "The sum of a weighting function over the functions of the module. "
+
+constexpr MetricDefinition metric_definitions[miLAST] =
+{
+  { miNOM, COUNT_TAG_NUMBER_OF_MODULES, miNOM, '\0', tmNONE,
+    "Number of modules",
+    "Number of non-trivial modules identified by the "
+    "analyser.  Non-trivial modules include all classes, "
+    "and any other module for which member functions are "
+    "identified." },
+  { miLOC, COUNT_TAG_LINES_OF_CODE, miLOC, '\0', tmLOC,
+    "Lines of Code",
+    "Number of non-blank, non-comment lines of source code "
+    "counted by the analyser." },
+  { miMVG, COUNT_TAG_CYCLOMATIC_NUMBER, miMVG, '\0', tmMVG,
+    "McCabe's Cyclomatic Complexity",
+    "A measure of the decision complexity of the functions "
+    "which make up the program."
+    "The strict definition of this measure is that it is "
+    "the number of linearly independent routes through "
+    "a directed acyclic graph which maps the flow of control "
+    "of a subprogram.  The analyser counts this by recording "
+    "the number of distinct decision outcomes contained "
+    "within each function, which yields a good approximation "
+    "to the formally defined version of the measure." },
+  { miCOM, COUNT_TAG_LINES_OF_COMMENT, miCOM, '\0', tmCOM,
+    "Lines of Comments",
+    "Number of lines of comment identified by the analyser" },
+  { miIF4, COUNT_TAG_INTERMODULE_COMPLEXITY4, miIF4, '\0', tmIF4,
+    "Information Flow measure",
+    "Measure of information flow between modules suggested "
+    "by Henry and Kafura. The analyser makes an approximate "
+    "count of this by counting inter-module couplings "
+    "identified in the module interfaces." },
+  { miIF4v, COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX,
+    miIF4, 'v', tmIF4v,
+    "Information Flow measure (visible)", "" },
+  { miIF4c, COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX,
+    miIF4, 'c', tmIF4c,
+    "Information Flow measure (concrete)", "" },
+  { miFI, COUNT_TAG_FAN_IN, miFI, '\0', tmFI,
+    "Fan in (overall)", "" },
+  { miFIv, COUNT_TAG_FAN_IN COUNT_TAG_VISIBLE_SUFFIX, miFI, 'v', tmFIv,
+    "Fan in (visible uses only)", "" },
+  { miFIc, COUNT_TAG_FAN_IN COUNT_TAG_CONCRETE_SUFFIX, miFI, 'c', tmFIc,
+    "Fan in (concrete uses only)", "" },
+  { miFO, COUNT_TAG_FAN_OUT, miFO, '\0', tmFO,
+    "Fan out (overall)", "" },
+  { miFOv, COUNT_TAG_FAN_OUT COUNT_TAG_VISIBLE_SUFFIX, miFO, 'v', tmFOv,
+    "Fan out (visible uses only)", "" },
+  { miFOc, COUNT_TAG_FAN_OUT COUNT_TAG_CONCRETE_SUFFIX, miFO, 'c', tmFOc,
+    "Fan out (concrete uses only)", "" },
+  { miWMC1, COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY, miWMC1, '\0', tmWMC1,
+    _WMC_NAME_START " (all)",
+    _WMC_DESCRIPTION_START "WMC1 uses the nominal weight of 1 for each "
+    "function, and hence measures the number of functions." },
+  { miWMCv, COUNT_TAG_WEIGHTED_METHODS_PER_CLASS COUNT_TAG_VISIBLE_SUFFIX,
+    miWMCv, '\0', tmWMCv,
+    _WMC_NAME_START " (visible)",
+    _WMC_DESCRIPTION_START "WMCv uses a weighting function which is 1 for functions "
+    "accessible to other modules, 0 for private functions."},
+  { miDIT, COUNT_TAG_INHERITANCE_TREE_DEPTH, miDIT, '\0', tmDIT,
+    "Depth of inheritance tree",
+    "The length of the longest path of inheritance ending at "
+    "the current module.  The deeper the inheritance tree "
+    "for a module, the harder it may be to predict its "
+    "behaviour.  On the other hand, increasing depth gives "
+    "the potential of greater reuse by the current module "
+    "of behaviour defined for ancestor classes." },
+  { miNOC, COUNT_TAG_NUMBER_OF_CHILDREN, miNOC, '\0', tmNOC,
+    "Number of children",
+    "The number of modules which inherit directly from the "
+    "current module.  Moderate values of this measure "
+    "indicate scope for reuse, however high values may "
+    "indicate an inappropriate abstraction in the design." },
+  { miCBO, COUNT_TAG_COUPLING_BETWEEN_OBJECTS, miCBO, '\0', tmCBO,
+    "Coupling between objects",
+    "The number of other modules which are coupled to the "
+    "current module either as a client or a supplier. "
+    "Excessive coupling indicates weakness of module "
+    "encapsulation and may inhibit reuse." },
+  { miMLOCpM, COUNT_TAG_MAX_LINES_OF_CODE_PER_METHOD, miMLOCpM, '\0', tmLOCf,
+    "Max Lines of Code per Method",
+    "The largest number of lines of code in a single method. "
+    "High LoC count may indicate poor functional isolation." },
+  { miL_C, "L_C", miL_C, '\0', tmL_C,
+    "Lines of code per line of comment",
+    "Indicates density of comments with respect to textual "
+    "size of program" },
+  { miM_C, "M_C", miM_C, '\0', tmM_C,
+    "Cyclomatic Complexity per line of comment",
+    "Indicates density of comments with respect to logical "
+    "complexity of program" },
+  { miLOCpM, "LOCpM", miLOCpM, '\0', tmLOCf,
+    "Lines of Code per Method",
+    "The average number of lines of code per method. "
+    "High LoC count may indicate poor functional isolation. "
+    "Note that this measure may be weighted low by large numbers of small accessor methods." }
+};
+
+#undef _WMC_NAME_START
+#undef _WMC_DESCRIPTION_START
+
+// the variant of a count with the given suffix
+constexpr MetricId metric_variant(MetricId base, char suffix)
+{
+  MetricId retval=base;
+  for(int i=0; i<miLAST; i++)
+    {
+      if(metric_definitions[i].base==base &&
+	 metric_definitions[i].suffix==suffix)
+	{
+	  retval=metric_definitions[i].id;
+	}
+    }
+  return retval;
+}
+
+// metric treatments
+// all metric values are displayed using the class CCCC_Metric, which may be
+// viewed as ratio of two integers associated with a character string tag
+// the denominator of the ratio defaults to 1, allowing simple counts to
+// be handled by the same code as is used for ratios
+//
+// the tag associated with a metric is used as a key to lookup a record
+// describing a policy for its display (class Metric_Treatment)
+//
+// the fields of each treatment record are as follows:
+// ID      the identifier by which the reports ask for the treatment.
+// CODE    the short string of characters used as the lookup key.
+// DEFAULT whether the code is given this treatment when no options file
+//         replaces it.
+// T1, T2  two numeric thresholds which are the lower bounds for the ratio of
+// the metric's numerator and denominator beyond which the
+//  value is treated as high or extreme by the analyser
+//  these will be displayed in emphasized fonts, and if the browser
+//  supports the BGCOLOR attribute, extreme values will have a red
+//  background, while high values will have a yellow background.
+//  The intent is that high values should be treated as suspicious but
+//  tolerable in moderation, whereas extreme values should almost
+//  always be regarded as defects (not necessarily that you will fix
+//  them).
+// NT  a third threshold which supresses calculation of ratios where
+//     the numerator is lower than NT.
+//     The principal reason for doing this is to prevent ratios like L_C
+//  being shown as *** (infinity) and displayed as extreme when the
+//  denominator is 0, providing the numerator is sufficiently low.
+//  Suitable values are probably similar to those for T1.
+// W       the width of the metric (total number of digits).
+// P       the precision of the metric (digits after the decimal point).
+// Comment the full name of the treatment.
+struct TreatmentDefinition
+{
+  TreatmentId id;
+  const char *code;
+  bool has_default;
+  float lower_threshold, upper_threshold;
+  int numerator_threshold, width, precision;
+  const char *name;
+};
+
+constexpr TreatmentDefinition treatment_definitions[tmLAST] =
+{
+  // ID        CODE      DEFAULT     T1      T2  NT W P Comment
+  { tmLOCf,    "LOCf",   true,      30,    100,  0, 6, 0, "Lines of code/function" },
+  { tmLOCm,    "LOCm",   true,     500,   2000,  0, 6, 0, "Lines of code/single module" },
+  { tmLOCper,  "LOCper", true,     500,   2000,  0, 6, 3, "Lines of code/average module" },
+  { tmLOCp,    "LOCp",   true,  999999, 999999,  0, 6, 0, "Lines of code/project" },
+  { tmLOCg,    "LOCg",   false,      0,      0,  0, 0, 0, "" },
+  { tmLOC,     "LOC",    false,      0,      0,  0, 0, 0, "" },
+  { tmMVGf,    "MVGf",   true,      10,     30,  0, 6, 0, "Cyclomatic complexity/function" },
+  { tmMVGm,    "MVGm",   true,     200,   1000,  0, 6, 0, "Cyclomatic complexity/single module" },
+  { tmMVGper,  "MVGper", true,     200,   1000,  0, 6, 3, "Cyclomatic complexity/average module" },
+  { tmMVGp,    "MVGp",   true,  999999, 999999,  0, 6, 0, "Cyclomatic complexity/project" },
+  { tmMVG,     "MVG",    false,      0,      0,  0, 0, 0, "" },
+  { tmCOM,     "COM",    true,  999999, 999999,  0, 6, 0, "Comment lines" },
+  { tmCOMm,    "COMm",   false,      0,      0,  0, 0, 0, "" },
+  { tmCOMper,  "COMper", true,  999999, 999999,  0, 6, 3, "Comment lines (averaged)" },
+  { tmM_C,     "M_C",    true,       5,     10,  5, 6, 3, "MVG/COM McCabe/comment line" },
+  { tmL_C,     "L_C",    true,       7,     30, 20, 6, 3, "LOC/COM Lines of code/comment line" },
+  { tmFI,      "FI",     true,      12,     20,  0, 6, 0, "Fan in (overall)" },
+  { tmFIv,     "FIv",    true,       6,     12,  0, 6, 0, "Fan in (visible uses only)" },
+  { tmFIc,     "FIc",    true,       6,     12,  0, 6, 0, "Fan in (concrete uses only)" },
+  { tmFO,      "FO",     true,      12,     20,  0, 6, 0, "Fan out (overall)" },
+  { tmFOv,     "FOv",    true,       6,     12,  0, 6, 0, "Fan out (visible uses only)" },
+  { tmFOc,     "FOc",    true,       6,     12,  0, 6, 0, "Fan out (concrete uses only)" },
+  { tmIF4,     "IF4",    true,     100,   1000,  0, 6, 0, "Henry-Kafura/Shepperd measure (overall)" },
+  { tmIF4v,    "IF4v",   true,      30,    100,  0, 6, 0, "Henry-Kafura/Shepperd measure (visible)" },
+  { tmIF4c,    "IF4c",   true,      30,    100,  0, 6, 0, "Henry-Kafura/Shepperd measure (concrete)" },
+  // WMC stands for weighted methods per class,
+  // the suffix distinguishes the weighting function
+  { tmWMC1,    "WMC1",   true,      30,    100,  0, 6, 0, "Weighting function=1 unit per method" },
+  { tmWMCv,    "WMCv",   true,      10,     30,  0, 6, 0, "Weighting function=1 unit per visible method" },
+  { tmDIT,     "DIT",    true,       3,      6,  0, 6, 0, "Depth of Inheritance Tree" },
+  { tmNOC,     "NOC",    true,       4,     15,  0, 6, 0, "Number of children" },
+  { tmCBO,     "CBO",    true,      12,     30,  0, 6, 0, "Coupling between objects" },
+  { tm8_3,     "8.3",    true,  999999, 999999,  0, 8, 3, "General format for fixed precision 3 d.p." },
+  { tmREJ,     "REJ",    false,      0,      0,  0, 0, 0, "" }
+};
+
+// each table must list its entries in the order of their identifiers
+constexpr bool metric_definitions_in_order()
+{
+  bool retval=true;
+  for(int i=0; i<miLAST; i++)
+    {
+      retval=retval && metric_definitions[i].id==i;
+    }
+  return retval;
+}
+static_assert(metric_definitions_in_order(),
+	      "metric_definitions must be in MetricId order");
+
+constexpr bool treatment_definitions_in_order()
+{
+  bool retval=true;
+  for(int i=0; i<tmLAST; i++)
+    {
+      retval=retval && treatment_definitions[i].id==i;
+    }
+  return retval;
+}
+static_assert(treatment_definitions_in_order(),
+	      "treatment_definitions must be in TreatmentId order");
+
+#endif // CCCC_MDF_H
@@ -32,15 +32,14 @@ CCCC_Member::CCCC_Member()
   visibility=vDONTKNOW;
 }
 
-int CCCC_Member::get_count(const char* count_tag) {
+int CCCC_Member::get_count(MetricId count_id) {
   int retval=0;
-  string count_tag_str=count_tag;
 
-  if(count_tag_str==COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY)
+  if(count_id==miWMC1)
     {
       retval=1;
     }
-  else if(count_tag_str==COUNT_TAG_WEIGHTED_METHODS_PER_CLASS COUNT_TAG_VISIBLE_SUFFIX)
+  else if(count_id==miWMCv)
     {
       switch(get_visibility())
 	{
@@ -54,7 +53,7 @@ int CCCC_Member::get_count(const char* count_tag) {
     }
   else
     {
-      retval=extent_table.get_count(count_tag);
+      retval=extent_table.get_count(count_id);
     }
 
   return retval;
@@ -73,9 +72,10 @@ int CCCC_Member::ToFile(ofstream& ofstr)
   member_line.Insert(param_list);
   member_line.ToFile(ofstr);
 
-  CCCC_Extent *extent_ptr=extent_table.first_item();
-  while(extent_ptr!=NULL)
+  Extent_Table::iterator extIter;
+  for(extIter=extent_table.begin(); extIter!=extent_table.end(); ++extIter)
     {
+      CCCC_Extent *extent_ptr=&*extIter;
       CCCC_Item extent_line;
       extent_line.Insert(MEMEXT_PREFIX);
       extent_line.Insert(parent->key());
@@ -84,8 +84,6 @@ int CCCC_Member::ToFile(ofstream& ofstr)
       extent_line.Insert(param_list);
       extent_ptr->AddToItem(extent_line);
       extent_line.ToFile(ofstr);
-
-      extent_ptr=extent_table.next_item();
     }
 
   if(ofstr.good())
@@ -187,7 +185,7 @@ int CCCC_Member::FromFile(ifstream& ifstr)
 	  // process extent records
 	  while(PeekAtNextLinePrefix(ifstr,MEMEXT_PREFIX))
 	    {
-	      CCCC_Extent *new_extent=new CCCC_Extent;
+	      CCCC_Extent new_extent;
 	      next_line.FromFile(ifstr);
 	      ifstr_line++;
 	      string parent_key_dummy, member_name_dummy,
@@ -199,19 +197,16 @@ int CCCC_Member::FromFile(ifstream& ifstr)
 		 next_line.Extract(member_name_dummy) &&
 		 next_line.Extract(member_type_dummy) &&
 		 next_line.Extract(param_list_dummy) &&
-		 new_extent->GetFromItem(next_line)
+		 new_extent.GetFromItem(next_line)
 		 )
 		{
 		  // We don't ever expect to find duplicated extent records
 		  // but just in case...
-		  CCCC_Extent *found_eptr=
-		    found_mptr->extent_table.find_or_insert(new_extent);
-		  if(found_eptr!=new_extent)
+		  if(!found_mptr->extent_table.insert(new_extent))
 		    {
 		      cerr << "Failed to add extent for member "
 			   << found_mptr->key() << " at line " << ifstr_line
 			   << endl;
-		      delete new_extent;
 		    }
 		}
 	    }
@@ -51,7 +51,7 @@ class CCCC_Member : public CCCC_Record
    * Sums counts across all extents
    * @ref CCCC_Extent::get_count
    */
-  int get_count(const char *count_tag);
+  int get_count(MetricId count_id);
   Visibility get_visibility();
 };
 
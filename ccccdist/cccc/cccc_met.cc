@@ -54,25 +54,34 @@ Metric_Treatment::Metric_Treatment(CCCC_Item& treatment_line)
     }
 }
 
+Metric_Treatment::Metric_Treatment(const TreatmentDefinition& definition)
+  : code(definition.code), name(definition.name),
+    lower_threshold(definition.lower_threshold),
+    upper_threshold(definition.upper_threshold),
+    numerator_threshold(definition.numerator_threshold),
+    width(definition.width), precision(definition.precision)
+{
+}
+
 CCCC_Metric::CCCC_Metric()
 {
   set_ratio(0,0);
-  set_treatment("");
+  set_treatment(tmNONE);
 }
 
-CCCC_Metric::CCCC_Metric(int n, const char* treatment_tag)
+CCCC_Metric::CCCC_Metric(int n, TreatmentId treatment_id)
 {
-  set_ratio(n,1); set_treatment(treatment_tag);
+  set_ratio(n,1); set_treatment(treatment_id);
 }
 
-CCCC_Metric::CCCC_Metric(int n, int d, const char* treatment_tag)
+CCCC_Metric::CCCC_Metric(int n, int d, TreatmentId treatment_id)
 {
-  set_ratio(n,d); set_treatment(treatment_tag);
+  set_ratio(n,d); set_treatment(treatment_id);
 }
 
-void CCCC_Metric::set_treatment(const char* code)
+void CCCC_Metric::set_treatment(TreatmentId treatment_id)
 {
-  treatment=CCCC_Options::getMetricTreatment(code);
+  treatment=CCCC_Options::getMetricTreatment(treatment_id);
 }
 
 void CCCC_Metric::set_ratio(float _num, float _denom)
@@ -167,39 +176,3 @@ string CCCC_Metric::value_string() const
   retval=valuestr.str();
   return retval;
 }
-
-const char *internal_treatments[] =
-{
-  "LOCf@30@100@0@6@0@Lines of code/function@",
-  "LOCm@500@2000@0@6@0@Lines of code/module @",
-  "LOCp@999999@999999@0@6@0@Lines of code/project @",
-  "MVGf@10@30@0@6@0@Cyclomatic complexity/function@",
-  "MVGm@200@1000@0@6@0@Cyclomatic complexity/module@",
-  "MVGp@999999@999999@0@6@0@Cyclomatic complexity/project@",
-  "COM@999999@999999@0@6@0@Comment lines@",
-  "M_C@5@10@5@6@3@MVG/COM McCabe/comment line@",
-  "L_C@7@30@20@6@3@LOC/COM Lines of code/comment line@",
-  "FI@12@20@0@6@0@Fan in (overall)@",
-  "FIv@6@12@0@6@0@Fan in (visible uses only)@",
-  "FIc@6@12@0@6@0@Fan in (concrete uses only)@",
-  "FO@12@20@0@6@0@Fan out (overall)@",
-  "FOv@6@12@0@6@0@Fan out (visible uses only)@",
-  "FOc@6@12@0@6@0@Fan out (concrete uses only)@",
-  "IF4@100@1000@0@6@0@Henry-Kafura/Shepperd measure (overall)@",
-  "IF4v@30@100@0@6@0@Henry-Kafura/Shepperd measure (visible only)@",
-  "IF4c@30@100@0@6@0@Henry-Kafura/Shepperd measure (concrete only)@",
-  "WMC1@30@100@0@6@0@Weighting function = 1 unit per method@",
-  "WMCv@10@30@0@6@0@Weighting function = 1 unit per visible method@",
-  "DIT@3@60@6@0@Depth of Inheritance Tree@",
-  "NOC@4@15@0@6@0@Number of children@",
-  "CBO@12@30@0@6@0@Coupling between objects@",
-  NULL
-};
-
-
-
-
-
-
-
-
@@ -37,7 +37,7 @@ class CCCC_Metric;
 class Metric_Treatment
 {
   friend class CCCC_Metric;
-  friend void add_treatment(CCCC_Item&);
+  friend void add_treatment(Metric_Treatment*);
   friend CCCC_Html_Stream& operator <<(CCCC_Html_Stream&,const CCCC_Metric&);
 
   // a short code string is used to search for the metric treatment, and
@@ -60,6 +60,7 @@ class Metric_Treatment
 
  public:
   Metric_Treatment(CCCC_Item& treatment_line);
+  Metric_Treatment(const TreatmentDefinition& definition);
 
   friend class CCCC_Options;
 };
@@ -71,9 +72,9 @@ class CCCC_Metric {
   friend CCCC_Metric& operator+(const CCCC_Metric&, const CCCC_Metric&);
  public:
   CCCC_Metric();
-  CCCC_Metric(int n, const char* treatment_tag="");
-  CCCC_Metric(int n, int d, const char* treatment_tag="");
-  void set_treatment(const char* code);
+  CCCC_Metric(int n, TreatmentId treatment_id=tmNONE);
+  CCCC_Metric(int n, int d, TreatmentId treatment_id=tmNONE);
+  void set_treatment(TreatmentId treatment_id);
   void set_ratio(float _num, float _denom=1.0);
   EmphasisLevel emphasis_level() const;
   string code() const;
@@ -27,6 +27,8 @@
 #include "cccc_db.h"
 
 CCCC_Module::CCCC_Module()
+: module_name(SymbolTable::EMPTY), module_type(SymbolTable::EMPTY),
+  counts_cached(false)
 {
   project=get_active_project();
 }
@@ -39,43 +41,66 @@ string CCCC_Module::name(int name_level) const
   switch(name_level)
     {
     case nlMODULE_TYPE:
-      retval=module_type;
+      retval=SymbolTable::text(module_type);
       break;
 
     case nlMODULE_NAME:
-      retval=module_name;
+      retval=SymbolTable::text(module_name);
       break;
 
     case nlMODULE_TYPE_AND_NAME:
-      retval=module_type;
+      retval=SymbolTable::text(module_type);
       if(retval.size()>0)
 	{
 	  retval=retval+" ";
 	}
-      retval=retval+module_name;
+      retval=retval+SymbolTable::text(module_name);
       break;
 
     default:
-      retval=module_name;
+      retval=SymbolTable::text(module_name);
     }
-  return retval.c_str();
+  return retval;
+}
+
+int CCCC_Module::get_count(MetricId count_id)
+{
+  int retval;
+  if(counts_cached)
+    {
+      retval=counts[count_id];
+    }
+  else
+    {
+      retval=compute_count(count_id);
+    }
+  return retval;
 }
 
-int CCCC_Module::get_count(const char* count_tag)
+void CCCC_Module::cache_counts()
+{
+  for(int i=0; i<miLAST; i++)
+    {
+      counts[i]=compute_count(static_cast<MetricId>(i));
+    }
+}
+
+int CCCC_Module::compute_count(MetricId count_id)
 {
   int retval=0;
-  if(strcmp(count_tag, COUNT_TAG_NUMBER_OF_MODULES)==0)
+  MetricId count_base=metric_definitions[count_id].base;
+  if(count_id==miNOM)
     {
       if(is_trivial()==FALSE)
 	{
 	  retval=1;
 	}
     }
-  else if(strcmp(count_tag, COUNT_TAG_COUPLING_BETWEEN_OBJECTS)==0)
+  else if(count_id==miCBO)
     {
       retval=client_map.size()+supplier_map.size();
     }
-  else if(strcmp(count_tag, COUNT_TAG_NUMBER_OF_CHILDREN)==0)
+  else if(count_id==miNOC)
     {
       retval=0;
 
@@ -90,14 +115,14 @@ int CCCC_Module::get_count(const char* count_tag)
 	  iter++;
 	}
     }
-  else if(strcmp(count_tag, COUNT_TAG_INHERITANCE_TREE_DEPTH)==0)
+  else if(count_id==miDIT)
     {
       retval=0;
 
       // cyclical inheritance relationships in code would
       // never compile, but this is no excuse for us allowing them
       // to cause us to overflow the stack
-      static int recursion_depth=0;
+      static thread_local int recursion_depth=0;
       recursion_depth++;
       if(recursion_depth>100)
 	{
@@ -114,7 +139,7 @@ int CCCC_Module::get_count(const char* count_tag)
 	      if((*iter).second->get_usetype()==utINHERITS)
 		{
 		  int parent_depth=
-		    (*iter).second->supplier_module_ptr(project)->get_count(COUNT_TAG_INHERITANCE_TREE_DEPTH);
+		    (*iter).second->supplier_module_ptr(project)->get_count(miDIT);
 		  if(retval<parent_depth+1)
 		    {
 		      retval=parent_depth+1;
@@ -125,61 +150,57 @@ int CCCC_Module::get_count(const char* count_tag)
 	}
       recursion_depth--;
     }
-  else if(strncmp(count_tag, COUNT_TAG_FAN_IN, 2)==0)
+  else if(count_base==miFI)
     {
       relationship_map_t::iterator iter;
       iter=supplier_map.begin();
       while(iter!=supplier_map.end())
 	{
-	  retval+=(*iter).second->get_count(count_tag);
+	  retval+=(*iter).second->get_count(count_id);
 	  iter++;
 	}
     }
-  else if(strncmp(count_tag, COUNT_TAG_FAN_OUT, 2)==0)
+  else if(count_base==miFO)
     {
       relationship_map_t::iterator iter;
       iter=client_map.begin();
       while(iter!=client_map.end())
 	{
-	  retval+=(*iter).second->get_count(count_tag);
+	  retval+=(*iter).second->get_count(count_id);
 	  iter++;
 	}
     }
-  else if(strncmp(count_tag, COUNT_TAG_INTERMODULE_COMPLEXITY4, 3)==0)
+  else if(count_base==miIF4)
     {
-      char if4_suffix=count_tag[3];
-      string fi_variant="FI", fo_variant="FO";
-      if(if4_suffix!=0)
-	{
-	  fi_variant+=if4_suffix;
-	  fo_variant+=if4_suffix;
-	}
-      retval=get_count(fi_variant.c_str())*get_count(fo_variant.c_str());
+      char if4_suffix=metric_definitions[count_id].suffix;
+      retval=get_count(metric_variant(miFI,if4_suffix))*
+	get_count(metric_variant(miFO,if4_suffix));
 	  retval*=retval;
     }
-  else if (strcmp(count_tag, COUNT_TAG_MAX_LINES_OF_CODE_PER_METHOD) == 0)
+  else if (count_id == miMLOCpM)
     {
       retval = 0;
-      for (member_map_t::iterator z = member_map.begin(); z != member_map.end(); ++z) {
-          int loc = z->second->get_count(COUNT_TAG_LINES_OF_CODE);
+      for (member_list_t::iterator z = member_list.begin(); z != member_list.end(); ++z) {
+          int loc = (*z)->get_count(miLOC);
           if (retval < loc)
               retval = loc;
       }
     }
   else
     {
-      CCCC_Extent *extPtr=extent_table.first_item();
-      while(extPtr!=NULL)
+      CCCC_Record::Extent_Table::iterator extIter=extent_table.begin();
+      while(extIter!=extent_table.end())
 	{
-	  int extent_count=extPtr->get_count(count_tag);
+	  CCCC_Extent *extPtr=&*extIter;
+	  int extent_count=extPtr->get_count(count_id);
 	  retval+=extent_count;
-	  extPtr=extent_table.next_item();
+	  extIter++;
 	}
 
-      member_map_t::iterator memIter=member_map.begin();
-      while(memIter!=member_map.end())
+      member_list_t::iterator memIter=member_list.begin();
+      while(memIter!=member_list.end())
 	{
-	  int member_count=(*memIter).second->get_count(count_tag);
+	  int member_count=(*memIter)->get_count(count_id);
 	  retval+=member_count;
 	  memIter++;
 	}
@@ -189,16 +210,21 @@ int CCCC_Module::get_count(const char* count_tag)
 
 int CCCC_Module::is_trivial()
 {
-  int retval=FALSE;
+  static const Symbol trivial_types[]=
+  {
+    SymbolTable::intern("builtin"),
+    SymbolTable::intern("enum"),
+    SymbolTable::intern("struct"),
+    SymbolTable::intern("trivial")
+  };
 
-  if(
-     (module_type=="builtin") ||
-     (module_type=="enum") ||
-     (module_type=="struct") ||
-     (module_type=="trivial")
-     )
+  int retval=FALSE;
+  for(size_t i=0; i<sizeof(trivial_types)/sizeof(trivial_types[0]); i++)
     {
-      retval=TRUE;
+      if(module_type==trivial_types[i])
+	{
+	  retval=TRUE;
+	}
     }
 
   return retval;
@@ -209,21 +235,22 @@ int CCCC_Module::ToFile(ofstream& ofstr)
   int retval=FALSE;
   CCCC_Item module_line;
   module_line.Insert(MODULE_PREFIX);
-  module_line.Insert(module_name);
-  module_line.Insert(module_type);
+  module_line.Insert(SymbolTable::text(module_name));
+  module_line.Insert(SymbolTable::text(module_type));
   module_line.ToFile(ofstr);
 
-  CCCC_Extent *extent_ptr=extent_table.first_item();
-  while(extent_ptr!=NULL)
+  CCCC_Record::Extent_Table::iterator extIter=extent_table.begin();
+  while(extIter!=extent_table.end())
     {
+      CCCC_Extent *extent_ptr=&*extIter;
       CCCC_Item extent_line;
       extent_line.Insert(MODEXT_PREFIX);
-      extent_line.Insert(module_name);
-      extent_line.Insert(module_type);
+      extent_line.Insert(SymbolTable::text(module_name));
+      extent_line.Insert(SymbolTable::text(module_type));
       extent_ptr->AddToItem(extent_line);
       extent_line.ToFile(ofstr);
 
-      extent_ptr=extent_table.next_item();
+      extIter++;
     }
 
   if(ofstr.good())
@@ -264,12 +291,13 @@ int CCCC_Module::FromFile(ifstream& ifstr)
       else
 	{
 	  retval=RECORD_TRANSCRIBED;
+	  Resolve_Fields(found_mptr->module_type,this->module_type);
 	}
 
       // process extent records
       while(PeekAtNextLinePrefix(ifstr,MODEXT_PREFIX))
 	{
-	  CCCC_Extent *new_extent=new CCCC_Extent;
+	  CCCC_Extent new_extent;
 	  next_line.FromFile(ifstr);
 	  ifstr_line++;
 	  string module_name_dummy, module_type_dummy;
@@ -278,19 +306,26 @@ int CCCC_Module::FromFile(ifstream& ifstr)
 	     next_line.Extract(line_keyword_dummy) &&
 	     next_line.Extract(module_name_dummy) &&
 	     next_line.Extract(module_type_dummy) &&
-	     new_extent->GetFromItem(next_line)
+	     new_extent.GetFromItem(next_line)
 	     )
 	    {
+	      // When more than one database file is loaded into the 
+	      // same project, each file repeats the definitions of the 
+	      // builtin types the project was primed with, so we drop 
+	      // any extent which exactly repeats one we already have.
+	      if(retval==RECORD_TRANSCRIBED && 
+		 found_mptr->has_equivalent_extent(new_extent))
+		{
+		  continue;
+		}
+
 	      // We don't ever expect to find duplicated extent records
 	      // but just in case...
-	      CCCC_Extent *found_eptr=
-		found_mptr->extent_table.find_or_insert(new_extent);
-	      if(found_eptr!=new_extent)
+	      if(!found_mptr->extent_table.insert(new_extent))
        		{
 		  cerr << "Failed to add extent for module "
 		       << found_mptr->key() << " at line " << ifstr_line
 		       << endl;
-		  delete new_extent;
 		}
 	    }
 	}
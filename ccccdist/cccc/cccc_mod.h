@@ -44,16 +44,28 @@ class CCCC_Module : public CCCC_Record
   friend class CCCC_Project;
   friend class CCCC_Html_Stream;
   friend class CCCC_Xml_Stream;
+  friend class CCCC_Query;
   CCCC_Project *project;
-  string module_name, module_type;
+  Symbol module_name, module_type;
 
-  typedef std::map<string,CCCC_Member*> member_map_t;
-  member_map_t member_map;
+  // reindex() lists the members of each module in order of their keys
+  typedef std::vector<CCCC_Member*> member_list_t;
+  member_list_t member_list;
 
-  typedef std::map<string,CCCC_UseRelationship*> relationship_map_t;
+  // the relationships of a module are held by the name of the module at 
+  // the other end, in the order of the names
+  typedef std::map<Symbol,CCCC_UseRelationship*,SymbolTextLess> 
+    relationship_map_t;
   relationship_map_t client_map;
   relationship_map_t supplier_map;
 
+  // reindex() works out every count of each module once, and they are 
+  // served from here until the project is next changed
+  int counts[miLAST];
+  bool counts_cached;
+  int compute_count(MetricId count_id);
+  void cache_counts();
+
   CCCC_Module();
 
 public:
@@ -65,10 +77,10 @@ public:
 
   /**
    * Implements special counters with tags NOM, CBO, NOC, DIT, FI, FO, and IF4
-   * Sums counts matching count_tag across all members
+   * Sums the count identified by count_id across all members
    * @ref CCCC_Member::get_count, CCCC_Extent::get_count
    */
-  virtual int get_count(const char *count_tag);
+  virtual int get_count(MetricId count_id);
   int is_trivial();
 };
 
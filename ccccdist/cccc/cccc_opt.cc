@@ -33,11 +33,11 @@ typedef std::map<dialect_keyword_t,string> dialect_keyword_map_t;
 
 static file_extension_language_map_t extension_map;
 static metric_treatment_map_t treatment_map;
+static Metric_Treatment *treatment_table[tmLAST];
 static dialect_keyword_map_t dialect_keyword_map;
 
 // these are declared extern so that it can be defined later in the file
 extern const char *default_fileext_options[];
-extern const char *default_treatment_options[];
 extern const char *default_dialect_options[];
 
 static void add_file_extension(CCCC_Item& fileext_line)
@@ -53,9 +53,18 @@ static void add_file_extension(CCCC_Item& fileext_line)
     }
 }
 
-void add_treatment(CCCC_Item& treatment_line)
+void add_treatment(Metric_Treatment *new_treatment)
 {
-	Metric_Treatment *new_treatment=new Metric_Treatment(treatment_line);
+	// the treatments of the codes the program knows about are also
+	// held by identifier, so that they can be found without a search
+	for(int i=0; i<tmLAST; i++)
+	{
+		if(new_treatment->code==treatment_definitions[i].code)
+		{
+			treatment_table[i]=new_treatment;
+		}
+	}
+
 	metric_treatment_map_t::iterator iter=
 		treatment_map.find(new_treatment->code);
 
@@ -72,6 +81,11 @@ void add_treatment(CCCC_Item& treatment_line)
     }
 }
 
+static void add_treatment(CCCC_Item& treatment_line)
+{
+	add_treatment(new Metric_Treatment(treatment_line));
+}
+
 static void add_dialect_keyword(CCCC_Item& dialect_keyword_line)
 {
 	string dialect, keyword, policy;
@@ -161,6 +175,23 @@ void CCCC_Options::Save_Options(const string& filename)
     }
 }
 
+string CCCC_Options::dialectKeywordSignature()
+{
+	string retval;
+	dialect_keyword_map_t::iterator dkIter;
+	for(dkIter=dialect_keyword_map.begin();
+	dkIter!=dialect_keyword_map.end();
+	++dkIter)
+    {
+		CCCC_Item dkLine;
+		dkLine.Insert((*dkIter).first.first);
+		dkLine.Insert((*dkIter).first.second);
+		dkLine.Insert((*dkIter).second);
+		retval+=dkLine.Text()+"\n";
+    }
+	return retval;
+}
+
 void CCCC_Options::Load_Options(const string& filename)
 {
 	ifstream optstr(filename.c_str());
@@ -195,14 +226,12 @@ void CCCC_Options::Load_Options()
 		option_ptr++;
     }
 
-	option_ptr=default_treatment_options;
-	while( (*option_ptr)!=NULL)
+	for(i=0; i<tmLAST; i++)
     {
-		string option_string="CCCC_MetTmnt@";
-		option_string+=(*option_ptr);
-		CCCC_Item option_line(option_string);
-		Add_Option(option_line);
-		option_ptr++;
+		if(treatment_definitions[i].has_default)
+		{
+			add_treatment(new Metric_Treatment(treatment_definitions[i]));
+		}
     }
 
 	option_ptr=default_dialect_options;
@@ -216,6 +245,18 @@ void CCCC_Options::Load_Options()
     }
 }
 
+bool CCCC_Options::hasFileLanguage(const string& filename)
+{
+	bool retval=(extension_map.find("")!=extension_map.end());
+	size_t extpos=filename.rfind(".");
+	if(extpos!=string::npos &&
+	   extension_map.find(filename.substr(extpos))!=extension_map.end())
+    {
+		retval=true;
+    }
+	return retval;
+}
+
 // map a filename to a language
 string CCCC_Options::getFileLanguage(const string& filename)
 {
@@ -249,14 +290,13 @@ string CCCC_Options::getFileLanguage(const string& filename)
 	return retval;
 }
 
-// map a metric name to a Metric_Treatment object
-Metric_Treatment *CCCC_Options::getMetricTreatment(const string& metric_tag)
+// map a treatment identifier to a Metric_Treatment object
+Metric_Treatment *CCCC_Options::getMetricTreatment(TreatmentId treatment_id)
 {
 	Metric_Treatment *retval=NULL;
-	metric_treatment_map_t::iterator iter=treatment_map.find(metric_tag);
-	if(iter!=treatment_map.end())
+	if(treatment_id!=tmNONE)
     {
-		retval=(*iter).second;
+		retval=treatment_table[treatment_id];
     }
 	return retval;
 }
@@ -322,72 +362,6 @@ const char *default_fileext_options[]=
 		NULL
 };
 
-const char *default_treatment_options[] =
-{
-	// metric treatments
-	// all metric values are displayed using the class CCCC_Metric, which may be
-	// viewed as ratio of two integers associated with a character string tag
-	// the denominator of the ratio defaults to 1, allowing simple counts to
-	// be handled by the same code as is used for ratios
-	//
-	// the tag associated with a metric is used as a key to lookup a record
-	// describing a policy for its display (class Metric_Treatment)
-	//
-	// the fields of each treatment record are as follows:
-	// TAG     the short string of characters used as the lookup key.
-	// T1, T2  two numeric thresholds which are the lower bounds for the ratio of
-	// the metric's numerator and denominator beyond which the
-	//  value is treated as high or extreme by the analyser
-	//  these will be displayed in emphasized fonts, and if the browser
-	//  supports the BGCOLOR attribute, extreme values will have a red
-	//  background, while high values will have a yellow background.
-	//  The intent is that high values should be treated as suspicious but
-	//  tolerable in moderation, whereas extreme values should almost
-	//  always be regarded as defects (not necessarily that you will fix
-	//  them).
-	// NT  a third threshold which supresses calculation of ratios where
-	//     the numerator is lower than NT.
-	//     The principal reason for doing this is to prevent ratios like L_C
-	//  being shown as *** (infinity) and displayed as extreme when the
-	//  denominator is 0, providing the numerator is sufficiently low.
-	//  Suitable values are probably similar to those for T1.
-	// W       the width of the metric (total number of digits).
-	// P       the precision of the metric (digits after the decimal point).
-	// Comment a free form field extending to the end of the line.
-
-	// TAG      T1      T2   NT  W  P Comment
-	"LOCf@      30@    100@   0@ 6@ 0@Lines of code/function@",
-	"LOCm@     500@   2000@   0@ 6@ 0@Lines of code/single module@",
-	"LOCper@   500@   2000@   0@ 6@ 3@Lines of code/average module@",
-	"LOCp@  999999@ 999999@   0@ 6@ 0@Lines of code/project@",
-	"MVGf@      10@     30@   0@ 6@ 0@Cyclomatic complexity/function@",
-	"MVGm@     200@   1000@   0@ 6@ 0@Cyclomatic complexity/single module@",
-	"MVGper@   200@   1000@   0@ 6@ 3@Cyclomatic complexity/average module@",
-	"MVGp@  999999@ 999999@   0@ 6@ 0@Cyclomatic complexity/project@",
-	"COM@   999999@ 999999@   0@ 6@ 0@Comment lines@",
-	"COMper@999999@ 999999@   0@ 6@ 3@Comment lines (averaged)@",
-	"M_C@        5@     10@   5@ 6@ 3@MVG/COM McCabe/comment line@",
-	"L_C@        7@     30@  20@ 6@ 3@LOC/COM Lines of code/comment line@",
-	"FI@        12@     20@   0@ 6@ 0@Fan in (overall)@",
-	"FIv@        6@     12@   0@ 6@ 0@Fan in (visible uses only)@",
-	"FIc@        6@     12@   0@ 6@ 0@Fan in (concrete uses only)@",
-	"FO@        12@     20@   0@ 6@ 0@Fan out (overall)@",
-	"FOv@	       6@     12@   0@ 6@ 0@Fan out (visible uses only)@",
-	"FOc@        6@     12@   0@ 6@ 0@Fan out (concrete uses only)@",
-	"IF4@      100@   1000@   0@ 6@ 0@Henry-Kafura/Shepperd measure (overall)@",
-	"IF4v@      30@    100@   0@ 6@ 0@Henry-Kafura/Shepperd measure (visible)@",
-	"IF4c@      30@    100@   0@ 6@ 0@Henry-Kafura/Shepperd measure (concrete)@",
-	 // WMC stands for weighted methods per class,
-	 // the suffix distinguishes the weighting function
-	 "WMC1@      30@    100@   0@ 6@ 0@Weighting function=1 unit per method@",
-	 "WMCv@      10@     30@   0@ 6@ 0@Weighting function=1 unit per visible method@",
-	 "DIT@	       3@      6@   0@ 6@ 0@Depth of Inheritance Tree@",
-	 "NOC@	       4@     15@   0@ 6@ 0@Number of children@",
-	 "CBO@	      12@     30@   0@ 6@ 0@Coupling between objects@",
-	 "8.3@    999999@ 999999@   0@ 8@ 3@General format for fixed precision 3 d.p.@",
-	 NULL
-};
-
 const char *default_dialect_options[] =
 {
 	// This configuration item allows the description of
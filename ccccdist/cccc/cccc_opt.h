@@ -54,14 +54,22 @@ class CCCC_Options
 
   // map a filename to a language
   static string getFileLanguage(const string& filename);
+
+  // this tells whether a filename can be mapped to a language, without
+  // complaining if it can't
+  static bool hasFileLanguage(const string& filename);
   
-  // map a metric name to a Metric_Treatment object
-  static Metric_Treatment *getMetricTreatment(const string& metric_tag);
+  // map a treatment identifier to a Metric_Treatment object
+  static Metric_Treatment *getMetricTreatment(TreatmentId treatment_id);
 
   // the following function allows the parser to use special 
   // handling rules for identifiers in particular situations
   // (especially pseudo-keywords like BEGIN_MESSAGE_MAP)
   static string dialectKeywordPolicy(const string& lang, const string& kw);
+
+  // this returns all of the dialect keyword policies as text, so that
+  // results which may depend on them can be told apart
+  static string dialectKeywordSignature();
 };
 
 #endif
@@ -30,7 +30,92 @@
 #include "cccc_prj.h"
 #include "cccc_db.h"
 
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// the number of shards each table is dealt into during concurrent ingestion
+static const size_t INGESTION_SHARDS=64;
+
+template <class T> struct IngestionShardSet
+{
+  CCCC_Table<T> table[INGESTION_SHARDS];
+  std::mutex lock[INGESTION_SHARDS];
+
+  // returns the shard to which a key belongs, having locked it
+  CCCC_Table<T>& lookup(const string& key, std::unique_lock<std::mutex>& held)
+  {
+    size_t i=std::hash<string>()(key)%INGESTION_SHARDS;
+    held=std::unique_lock<std::mutex>(lock[i]);
+    return table[i];
+  }
+
+  void deal_out(CCCC_Table<T>& whole)
+  {
+    typename CCCC_Table<T>::iterator iter;
+    for(iter=whole.begin(); iter!=whole.end(); ++iter)
+      {
+	table[std::hash<string>()((*iter).first)%INGESTION_SHARDS].insert(*iter);
+      }
+    whole.clear();
+  }
+
+  // the tables are ordered by key, so the order in which the shards
+  // are gathered in makes no difference to the order of the whole
+  void gather_in(CCCC_Table<T>& whole)
+  {
+    for(size_t i=0; i<INGESTION_SHARDS; i++)
+      {
+	whole.insert(table[i].begin(),table[i].end());
+	table[i].clear();
+      }
+  }
+};
+
+// Rejected extents have no name to hash, so they are dealt out by the 
+// block of their key, which keeps those from each file together.
+struct ExtentShardSet
+{
+  CCCC_ExtentList list[INGESTION_SHARDS];
+  std::mutex lock[INGESTION_SHARDS];
+
+  CCCC_ExtentList& lookup(unsigned long long key, 
+			  std::unique_lock<std::mutex>& held)
+  {
+    size_t i=(key>>32)%INGESTION_SHARDS;
+    held=std::unique_lock<std::mutex>(lock[i]);
+    return list[i];
+  }
+
+  // the lists are ordered by key, so the extents already held can all 
+  // go into one shard and still be found in order when gathered in
+  void deal_out(CCCC_ExtentList& whole)
+  {
+    list[0].take_all(whole);
+  }
+
+  void gather_in(CCCC_ExtentList& whole)
+  {
+    for(size_t i=0; i<INGESTION_SHARDS; i++)
+      {
+	whole.take_all(list[i]);
+      }
+  }
+};
+
+struct CCCC_Project::IngestionShards
+{
+  IngestionShardSet<CCCC_Module> modules;
+  IngestionShardSet<CCCC_Member> members;
+  IngestionShardSet<CCCC_UseRelationship> userels;
+  ExtentShardSet rejected_extents;
+};
+
 CCCC_Project::CCCC_Project(const string& name)
+: shards(NULL), counts_cached(false)
 {
   // we prime the database with knowledge of the builtin base types
   // we also add a record for the anonymous class which we will treat
@@ -55,27 +140,49 @@ CCCC_Project::CCCC_Project(const string& name)
 
 void CCCC_Project::add_module(CCCC_Item& module_line) {
   char linebuf[1024];
+  uncache_counts();
 
-  CCCC_Module *module_ptr=new CCCC_Module;
-  CCCC_Extent *extent_ptr=new CCCC_Extent;
+  string module_name, module_type;
+  CCCC_Extent new_extent;
 
   if(
-     module_line.Extract(module_ptr->module_name) &&
-     module_line.Extract(module_ptr->module_type) &&
-     extent_ptr->GetFromItem(module_line)
+     module_line.Extract(module_name) &&
+     module_line.Extract(module_type) &&
+     new_extent.GetFromItem(module_line)
      )
     {
-      CCCC_Module *lookup_module_ptr=module_table.find_or_insert(module_ptr);
-      if(lookup_module_ptr != NULL)
+      // the key of a module is its name, so a new module object is only
+      // made when there is no record of the module yet
+      std::unique_lock<std::mutex> module_lock;
+      CCCC_Table<CCCC_Module>& table=(shards==NULL) ? module_table :
+	shards->modules.lookup(module_name,module_lock);
+      CCCC_Module *lookup_module_ptr=table.find(module_name);
+      if(lookup_module_ptr == NULL)
 	{
-	  lookup_module_ptr->extent_table.find_or_insert(extent_ptr);
+	  lookup_module_ptr=new CCCC_Module;
+	  lookup_module_ptr->module_name=SymbolTable::intern(module_name);
+	  lookup_module_ptr->module_type=SymbolTable::intern(module_type);
+	  table.find_or_insert(lookup_module_ptr);
+	  lookup_module_ptr->extent_table.insert(new_extent);
+	}
+      else
+	{
+	  unsigned long long first_key=lookup_module_ptr->first_extent_key();
+	  lookup_module_ptr->extent_table.insert(new_extent);
 
-	  if(lookup_module_ptr!=module_ptr)
+	  // transfer knowledge from the new record
+	  // When records are added from several threads, one from an 
+	  // earlier file may turn up late, in which case it takes 
+	  // precedence as it would have done in a serial run.
+	  Symbol type_symbol=SymbolTable::intern(module_type);
+	  if(first_key>0 && new_extent.get_key()<first_key &&
+	     type_symbol!=SymbolTable::EMPTY)
+	    {
+	      lookup_module_ptr->module_type=type_symbol;
+	    }
+	  else
 	    {
-	      // do some work to transfer knowledge from the new module object
-	      // then delete it
-	      Resolve_Fields(lookup_module_ptr->module_type,module_ptr->module_type);
-	      delete module_ptr;
+	      Resolve_Fields(lookup_module_ptr->module_type,type_symbol);
 	    }
 	}
     }
@@ -87,174 +194,362 @@ void CCCC_Project::add_module(CCCC_Item& module_line) {
 
 void CCCC_Project::add_member(CCCC_Item& member_data_line)
 {
-  CCCC_Module *new_module_ptr=new CCCC_Module;
+  uncache_counts();
+  string module_name;
   CCCC_Member *new_member_ptr=new CCCC_Member;
   if(
-     member_data_line.Extract(new_module_ptr->module_name) &&
+     member_data_line.Extract(module_name) &&
      member_data_line.Extract(new_member_ptr->member_name) &&
      member_data_line.Extract(new_member_ptr->member_type) &&
      member_data_line.Extract(new_member_ptr->param_list)
      )
     {
-      CCCC_Module *found_module_ptr=module_table.find_or_insert(new_module_ptr);
-      if(found_module_ptr==new_module_ptr)
+      // The key of a member depends on its parent module, so the 
+      // module's shard is held until the member has been added.
+      std::unique_lock<std::mutex> module_lock, member_lock;
+      CCCC_Table<CCCC_Module>& modules=(shards==NULL) ? module_table :
+	shards->modules.lookup(module_name,module_lock);
+      CCCC_Module *found_module_ptr=modules.find(module_name);
+      if(found_module_ptr==NULL)
 	{
-	  // protect the new module from deletion at the end of this function
-	  new_module_ptr=NULL;
+	  found_module_ptr=new CCCC_Module;
+	  found_module_ptr->module_name=SymbolTable::intern(module_name);
+	  modules.find_or_insert(found_module_ptr);
 	}
 
       new_member_ptr->parent=found_module_ptr;
-      CCCC_Member *found_member_ptr=member_table.find_or_insert(new_member_ptr);
+      CCCC_Table<CCCC_Member>& members=(shards==NULL) ? member_table :
+	shards->members.lookup(new_member_ptr->key(),member_lock);
+      CCCC_Member *found_member_ptr=members.find_or_insert(new_member_ptr);
       if(found_member_ptr==new_member_ptr)
 	{
 	  new_member_ptr=NULL;
 	}
+      unsigned long long first_key=found_member_ptr->first_extent_key();
       found_member_ptr->add_extent(member_data_line);
+      if(
+	 new_member_ptr!=NULL && first_key>0 &&
+	 found_member_ptr->first_extent_key()!=first_key
+	 )
+	{
+	  // this record has turned up after one from a later file
+	  found_member_ptr->member_type=new_member_ptr->member_type;
+	}
     }
   else
     {
       cerr << "CCCC_Project::add_module extraction failed" << endl;
     }
 
-  // clean up newly allocated records if they have not been accepted
+  // clean up the newly allocated record if it has not been accepted
   // into the database
-  delete new_module_ptr;
   delete new_member_ptr;
 }
 
 void CCCC_Project::add_userel(CCCC_Item& userel_data_line) {
+  uncache_counts();
   CCCC_UseRelationship *new_userel_ptr =
     new CCCC_UseRelationship(userel_data_line);
+  std::unique_lock<std::mutex> userel_lock;
+  CCCC_Table<CCCC_UseRelationship>& table=(shards==NULL) ? userel_table :
+    shards->userels.lookup(new_userel_ptr->key(),userel_lock);
   CCCC_UseRelationship *lookup_userel_ptr =
-    userel_table.find_or_insert(new_userel_ptr);
+    table.find_or_insert(new_userel_ptr);
 
   if(lookup_userel_ptr != NULL)
     {
+      unsigned long long first_key=lookup_userel_ptr->first_extent_key();
+      lookup_userel_ptr->add_extent(userel_data_line);
       if(new_userel_ptr != lookup_userel_ptr)
 	{
+	  if(
+	     first_key>0 && 
+	     lookup_userel_ptr->first_extent_key()!=first_key
+	     )
+	    {
+	      // this record has turned up after one from a later file
+	      lookup_userel_ptr->member=new_userel_ptr->member;
+	    }
 	  delete new_userel_ptr;
 	}
-      lookup_userel_ptr->add_extent(userel_data_line);
     }
 #if DEBUG_USEREL
-  cerr << "Adding " << lookup_userel_ptr->client << " uses "
-       << lookup_userel_ptr->supplier << endl;
+  cerr << "Adding " << lookup_userel_ptr->name(nlSIMPLE) << endl;
 #endif
 }
 
 void CCCC_Project::add_rejected_extent(CCCC_Item& rejected_data_line)
 {
-  CCCC_Extent *new_extent=new CCCC_Extent(rejected_data_line);
-  rejected_extent_table.find_or_insert(new_extent);
+  CCCC_Extent new_extent(rejected_data_line);
+  std::unique_lock<std::mutex> rejected_extent_lock;
+  CCCC_ExtentList& list=(shards==NULL) ? rejected_extent_table :
+    shards->rejected_extents.lookup(new_extent.get_key(),
+				    rejected_extent_lock);
+  list.insert(new_extent);
+}
+
+void CCCC_Project::begin_concurrent_ingestion()
+{
+  // the flag is only read while records are being added from several 
+  // threads, as it has been cleared here
+  uncache_counts();
+  shards=new IngestionShards;
+  shards->modules.deal_out(module_table);
+  shards->members.deal_out(member_table);
+  shards->userels.deal_out(userel_table);
+  shards->rejected_extents.deal_out(rejected_extent_table);
+}
+
+void CCCC_Project::end_concurrent_ingestion()
+{
+  shards->modules.gather_in(module_table);
+  shards->members.gather_in(member_table);
+  shards->userels.gather_in(userel_table);
+  shards->rejected_extents.gather_in(rejected_extent_table);
+  delete shards;
+  shards=NULL;
+}
+
+// runs job(0) to job(threads-1) at once, the calling thread taking job(0)
+static void run_partitions(int threads, const std::function<void(int)>& job)
+{
+  std::vector<std::thread> workers;
+  for(int t=1; t<threads; t++)
+    {
+      workers.push_back(std::thread(job,t));
+    }
+  job(0);
+  for(size_t i=0; i<workers.size(); i++)
+    {
+      workers[i].join();
+    }
+}
+
+// the first and last+1 of the items which partition t of threads works on
+static void partition_range(size_t items, int t, int threads,
+			    size_t& begin, size_t& end)
+{
+  begin=items*t/threads;
+  end=items*(t+1)/threads;
+}
+
+// the partition which fills in the maps of a module, so that each
+// module's maps are only ever written by one thread
+static int owning_partition(const CCCC_Module *module_ptr, int threads)
+{
+  return std::hash<const CCCC_Module*>()(module_ptr)%threads;
 }
 
-void CCCC_Project::reindex()
+void CCCC_Project::uncache_counts()
 {
-  CCCC_Member *member_ptr=member_table.first_item();
-  while(member_ptr!=NULL)
+  if(counts_cached)
     {
-      if(member_ptr->parent!=NULL)
+      CCCC_Table<CCCC_Module>::iterator modIter;
+      for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
 	{
-	  CCCC_Module::member_map_t::value_type
-	    new_pair(member_ptr->key(),member_ptr);
-	  member_ptr->parent->member_map.insert(new_pair);
+	  (*modIter).second->counts_cached=false;
 	}
-      else
+      counts_cached=false;
+    }
+}
+
+void CCCC_Project::reindex(int threads)
+{
+  if(threads<1)
+    {
+      threads=1;
+    }
+  uncache_counts();
+
+  // Each partition works out the visibility of a run of members, and
+  // passes each member on to the partition owning its parent module.
+  typedef std::vector<CCCC_Member*> member_list;
+  member_list members;
+  CCCC_Table<CCCC_Member>::iterator memIter;
+  for(memIter=member_table.begin(); memIter!=member_table.end(); ++memIter)
+    {
+      members.push_back((*memIter).second);
+    }
+
+  std::vector< std::vector<member_list> > 
+    members_for(threads,std::vector<member_list>(threads));
+  std::vector<member_list> orphans(threads);
+  run_partitions(threads,[&](int t)
+    {
+      size_t begin, end;
+      partition_range(members.size(),t,threads,begin,end);
+      for(size_t i=begin; i<end; i++)
 	{
-	  cerr << "Member " << member_ptr->key() << " has no parent"
+	  CCCC_Member *member_ptr=members[i];
+	  if(member_ptr->parent!=NULL)
+	    {
+	      int owner=owning_partition(member_ptr->parent,threads);
+	      members_for[t][owner].push_back(member_ptr);
+	    }
+	  else
+	    {
+	      orphans[t].push_back(member_ptr);
+	    }
+
+	  CCCC_Record::Extent_Table::iterator extIter;
+	  for(extIter=member_ptr->extent_table.begin();
+	      extIter!=member_ptr->extent_table.end();
+	      ++extIter)
+	    {
+	      Visibility extent_visibility=extIter->get_visibility();
+	      Visibility member_visibility=member_ptr->get_visibility();
+
+	      if(member_ptr->visibility==vDONTKNOW)
+		{
+		  member_ptr->visibility=extent_visibility;
+		}
+	      else if(
+		      (extent_visibility!=vDONTKNOW) &&
+		      (member_visibility!=extent_visibility)
+		      )
+		{
+		  member_ptr->visibility=vINVALID;
+		}
+	    }
+	}
+    });
+
+  for(int t=0; t<threads; t++)
+    {
+      for(size_t i=0; i<orphans[t].size(); i++)
+	{
+	  cerr << "Member " << orphans[t][i]->key() << " has no parent"
 	       << endl;
 	}
+    }
 
-      CCCC_Extent *extent_ptr=member_ptr->extent_table.first_item();
-      while(extent_ptr!=NULL)
+  // The members reach each module in the order of the member table, 
+  // but the key of a member is made from its parent's name and type,
+  // which may have been settled since the member was added, so each 
+  // list is put in order of the keys as they are now, keeping only the
+  // first member with each key.
+  run_partitions(threads,[&](int t)
+    {
+      std::vector<CCCC_Module*> parents;
+      for(int source=0; source<threads; source++)
 	{
-	  Visibility extent_visibility=extent_ptr->get_visibility();
-	  Visibility member_visibility=member_ptr->get_visibility();
+	  member_list& mine=members_for[source][t];
+	  for(size_t i=0; i<mine.size(); i++)
+	    {
+	      CCCC_Module *parent_ptr=mine[i]->parent;
+	      if(parent_ptr->member_list.empty())
+		{
+		  parents.push_back(parent_ptr);
+		}
+	      parent_ptr->member_list.push_back(mine[i]);
+	    }
+	}
 
-	  if(member_ptr->visibility==vDONTKNOW)
+      std::vector< std::pair<string,CCCC_Member*> > keyed;
+      for(size_t i=0; i<parents.size(); i++)
+	{
+	  CCCC_Module::member_list_t& list=parents[i]->member_list;
+	  keyed.clear();
+	  for(size_t j=0; j<list.size(); j++)
 	    {
-	      member_ptr->visibility=extent_visibility;
+	      keyed.push_back(std::make_pair(list[j]->key(),list[j]));
 	    }
-	  else if(
-		  (extent_visibility!=vDONTKNOW) &&
-		  (member_visibility!=extent_visibility)
-		  )
+	  std::stable_sort(keyed.begin(),keyed.end(),
+			   [](const std::pair<string,CCCC_Member*>& k1,
+			      const std::pair<string,CCCC_Member*>& k2)
+			   { return k1.first<k2.first; });
+	  list.clear();
+	  for(size_t j=0; j<keyed.size(); j++)
 	    {
-	      member_ptr->visibility=vINVALID;
+	      if(j==0 || keyed[j].first!=keyed[j-1].first)
+		{
+		  list.push_back(keyed[j].second);
+		}
 	    }
-
-	  extent_ptr=member_ptr->extent_table.next_item();
 	}
+    });
 
-      member_ptr=member_table.next_item();
+  // The modules at either end of each relationship are looked up 
+  // in parallel, as the module table is only read while this happens.
+  std::vector<CCCC_UseRelationship*> userels;
+  CCCC_Table<CCCC_UseRelationship>::iterator useIter;
+  for(useIter=userel_table.begin(); useIter!=userel_table.end(); ++useIter)
+    {
+      userels.push_back((*useIter).second);
     }
 
-  CCCC_UseRelationship *userel_ptr=userel_table.first_item();
-  while(userel_ptr!=NULL)
+  std::vector<CCCC_Module*> suppliers(userels.size()), clients(userels.size());
+  run_partitions(threads,[&](int t)
     {
-      CCCC_Module *supplier_ptr=new CCCC_Module;
-      supplier_ptr->module_name=userel_ptr->supplier;
-      CCCC_Module *found_supplier_ptr=
-	module_table.find_or_insert(supplier_ptr);
-      if(found_supplier_ptr!=supplier_ptr)
+      size_t begin, end;
+      partition_range(userels.size(),t,threads,begin,end);
+      for(size_t i=begin; i<end; i++)
 	{
-	  delete supplier_ptr;
-	  supplier_ptr=found_supplier_ptr;
+	  suppliers[i]=userels[i]->supplier_module_ptr(this);
+	  clients[i]=userels[i]->client_module_ptr(this);
 	}
+    });
 
-      CCCC_Module *client_ptr=new CCCC_Module;
-      client_ptr->module_name=userel_ptr->client;
-      CCCC_Module *found_client_ptr=module_table.find_or_insert(client_ptr);
-      if(found_client_ptr!=client_ptr)
+  // modules which are used but have no record of their own are
+  // created here
+  for(size_t i=0; i<userels.size(); i++)
+    {
+      CCCC_Module **ends[]={ &suppliers[i], &clients[i] };
+      Symbol names[]={ userels[i]->supplier, userels[i]->client };
+      for(int j=0; j<2; j++)
 	{
-	  delete client_ptr;
-	  client_ptr=found_client_ptr;
+	  if(*ends[j]==NULL)
+	    {
+	      CCCC_Module *module_ptr=new CCCC_Module;
+	      module_ptr->module_name=names[j];
+	      *ends[j]=module_table.find_or_insert(module_ptr);
+	      if(*ends[j]!=module_ptr)
+		{
+		  delete module_ptr;
+		}
+	    }
 	}
+    }
 
-      if(
-	 (userel_ptr->supplier==userel_ptr->client) ||
-	 userel_ptr->supplier=="" ||
-	 userel_ptr->client=="" ||
-	 supplier_ptr->is_trivial() ||
-	 client_ptr->is_trivial()
-	 )
-	{
-#if DEBUG_USEREL
-	  cerr << "Removing relationship between "
-	       << userel_ptr->supplier.c_str()
-	       << " and "
-	       << userel_ptr->client.c_str()
-	       << endl;
-#endif
-	  userel_table.remove(userel_ptr);
-	  delete userel_ptr;
-	}
-      else
+  typedef std::vector<size_t> link_list;
+  std::vector< std::vector<link_list> >
+    supplier_links_for(threads,std::vector<link_list>(threads)),
+    client_links_for(threads,std::vector<link_list>(threads));
+  std::vector<char> trivial(userels.size());
+  run_partitions(threads,[&](int t)
+    {
+      size_t begin, end;
+      partition_range(userels.size(),t,threads,begin,end);
+      for(size_t i=begin; i<end; i++)
 	{
-	  // create links from the client and supplier modules to the
-	  // relationship object
-#if DEBUG_USEREL
-	  std::cerr << "Creating links for "
-		    << client_ptr->key()
-		    << " (" << client_ptr << ") uses "
-		    << supplier_ptr->key()
-		    << " (" << supplier_ptr << ")" << std::endl;
-#endif
+	  CCCC_UseRelationship *userel_ptr=userels[i];
+	  trivial[i]=
+	    (userel_ptr->supplier==userel_ptr->client) ||
+	    userel_ptr->supplier==SymbolTable::EMPTY ||
+	    userel_ptr->client==SymbolTable::EMPTY ||
+	    suppliers[i]->is_trivial() ||
+	    clients[i]->is_trivial();
+	  if(trivial[i])
+	    {
+	      continue;
+	    }
 
-	  CCCC_Module::relationship_map_t::value_type
-	    new_supplier_pair(supplier_ptr->key(), userel_ptr),
-	    new_client_pair(client_ptr->key(), userel_ptr);
-	  client_ptr->supplier_map.insert(new_supplier_pair);
-	  supplier_ptr->client_map.insert(new_client_pair);
+	  // the client's supplier map and the supplier's client map 
+	  // are filled in by the partitions which own them
+	  supplier_links_for[t][owning_partition(clients[i],threads)].push_back(i);
+	  client_links_for[t][owning_partition(suppliers[i],threads)].push_back(i);
 
 	  // calculate the visibility and concreteness of the
 	  // relationship
 	  AugmentedBool visible=abDONTKNOW;
 	  AugmentedBool concrete=abDONTKNOW;
 
-	  CCCC_Extent *extent_ptr=userel_ptr->extent_table.first_item();
-	  while(extent_ptr!=NULL)
+	  CCCC_Record::Extent_Table::iterator extIter;
+	  for(extIter=userel_ptr->extent_table.begin();
+	      extIter!=userel_ptr->extent_table.end();
+	      ++extIter)
 	    {
+	      CCCC_Extent *extent_ptr=&*extIter;
 	      switch(extent_ptr->get_visibility())
 		{
 		case vPRIVATE:
@@ -293,23 +588,291 @@ void CCCC_Project::reindex()
 		  // nothing to do
 		  ;
 		}
-
-	      extent_ptr=userel_ptr->extent_table.next_item();
 	    }
 	  userel_ptr->visible=visible;
 	  userel_ptr->concrete=concrete;
 	}
+    });
+
+  for(size_t i=0; i<userels.size(); i++)
+    {
+      CCCC_UseRelationship *userel_ptr=userels[i];
+      if(trivial[i])
+	{
+#if DEBUG_USEREL
+	  cerr << "Removing relationship between "
+	       << userel_ptr->name(nlSUPPLIER)
+	       << " and "
+	       << userel_ptr->name(nlCLIENT)
+	       << endl;
+#endif
+	  userel_table.remove(userel_ptr);
+	  trivial_userel_table.find_or_insert(userel_ptr);
+	  userels[i]=NULL;
+	}
+#if DEBUG_USEREL
+      else
+	{
+	  std::cerr << "Creating links for "
+		    << clients[i]->key()
+		    << " (" << clients[i] << ") uses "
+		    << suppliers[i]->key()
+		    << " (" << suppliers[i] << ")" << std::endl;
+	}
+#endif
+    }
+
+  // create links from the client and supplier modules to the
+  // relationship objects
+  run_partitions(threads,[&](int t)
+    {
+      for(int source=0; source<threads; source++)
+	{
+	  link_list& supplier_links=supplier_links_for[source][t];
+	  for(size_t j=0; j<supplier_links.size(); j++)
+	    {
+	      size_t i=supplier_links[j];
+	      CCCC_Module::relationship_map_t::value_type
+		new_supplier_pair(suppliers[i]->module_name, userels[i]);
+	      clients[i]->supplier_map.insert(new_supplier_pair);
+	    }
+
+	  link_list& client_links=client_links_for[source][t];
+	  for(size_t j=0; j<client_links.size(); j++)
+	    {
+	      size_t i=client_links[j];
+	      CCCC_Module::relationship_map_t::value_type
+		new_client_pair(clients[i]->module_name, userels[i]);
+	      suppliers[i]->client_map.insert(new_client_pair);
+	    }
+	}
+    });
+
+  // The counts of every module are worked out now, so that the reports 
+  // need not work them out again each time they ask.  No module serves 
+  // its cached counts until all of them have been filled, as the counts 
+  // of one module may depend on those of others.
+  std::vector<CCCC_Module*> modules;
+  CCCC_Table<CCCC_Module>::iterator modIter;
+  for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
+    {
+      modules.push_back((*modIter).second);
+    }
+  run_partitions(threads,[&](int t)
+    {
+      size_t begin, end;
+      partition_range(modules.size(),t,threads,begin,end);
+      for(size_t i=begin; i<end; i++)
+	{
+	  modules[i]->cache_counts();
+	}
+    });
+  for(size_t i=0; i<modules.size(); i++)
+    {
+      modules[i]->counts_cached=true;
+    }
+  counts_cached=true;
+}
+
+
+void CCCC_Project::unindex()
+{
+  uncache_counts();
+  CCCC_Table<CCCC_Module>::iterator modIter;
+  for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
+    {
+      (*modIter).second->member_list.clear();
+      (*modIter).second->client_map.clear();
+      (*modIter).second->supplier_map.clear();
+    }
+
+  CCCC_Table<CCCC_Member>::iterator memIter;
+  for(memIter=member_table.begin(); memIter!=member_table.end(); ++memIter)
+    {
+      (*memIter).second->visibility=vDONTKNOW;
+    }
 
-      userel_ptr=userel_table.next_item();
+  userel_table.insert(trivial_userel_table.begin(),trivial_userel_table.end());
+  trivial_userel_table.clear();
+
+  // this also drops the modules which reindex() created because they 
+  // were used, but which had no records of their own
+  remove_empty_records();
+}
+
+void CCCC_Project::index_file_extents()
+{
+  file_extent_table.clear();
+
+  std::vector<CCCC_ExtentList*> lists;
+  CCCC_Table<CCCC_Module>::iterator modIter;
+  for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
+    {
+      lists.push_back(&(*modIter).second->extent_table);
+    }
+  CCCC_Table<CCCC_Member>::iterator memIter;
+  for(memIter=member_table.begin(); memIter!=member_table.end(); ++memIter)
+    {
+      lists.push_back(&(*memIter).second->extent_table);
+    }
+  CCCC_Table<CCCC_UseRelationship>::iterator useIter;
+  for(useIter=userel_table.begin(); useIter!=userel_table.end(); ++useIter)
+    {
+      lists.push_back(&(*useIter).second->extent_table);
+    }
+  lists.push_back(&rejected_extent_table);
+
+  for(size_t i=0; i<lists.size(); i++)
+    {
+      CCCC_ExtentList::iterator extIter;
+      for(extIter=lists[i]->begin(); extIter!=lists[i]->end(); ++extIter)
+	{
+	  ExtentTableEntry entry;
+	  entry.list_ptr=lists[i];
+	  entry.key=extIter->get_key();
+	  FileExtentTable::value_type 
+	    new_pair(extIter->name(nlFILENAME),entry);
+	  file_extent_table.insert(new_pair);
+	}
     }
 }
 
+void CCCC_Project::purge_file(const string& filename)
+{
+  uncache_counts();
+  std::pair<FileExtentTable::iterator,FileExtentTable::iterator> range=
+    file_extent_table.equal_range(filename);
+
+  // the extents of a list are removed together, in one pass over it
+  std::map<CCCC_ExtentList*, std::set<unsigned long long> > doomed_keys;
+  FileExtentTable::iterator fileIter;
+  for(fileIter=range.first; fileIter!=range.second; ++fileIter)
+    {
+      ExtentTableEntry& entry=(*fileIter).second;
+      doomed_keys[entry.list_ptr].insert(entry.key);
+    }
+  std::map<CCCC_ExtentList*, std::set<unsigned long long> >::iterator 
+    doomedIter;
+  for(doomedIter=doomed_keys.begin(); 
+      doomedIter!=doomed_keys.end(); 
+      ++doomedIter)
+    {
+      (*doomedIter).first->remove((*doomedIter).second);
+    }
+  file_extent_table.erase(range.first,range.second);
+  file_cost_table.erase(filename);
+  file_hash_table.erase(filename);
+}
 
-int CCCC_Project::get_count(const char* count_tag)
+void CCCC_Project::remove_empty_records()
+{
+  uncache_counts();
+  // Members and relationships only exist because of their extents, 
+  // but a module may be there only as the parent of its members.
+  std::set<CCCC_Module*> parents;
+  std::vector<CCCC_Member*> empty_members;
+  CCCC_Table<CCCC_Member>::iterator memIter;
+  for(memIter=member_table.begin(); memIter!=member_table.end(); ++memIter)
+    {
+      CCCC_Member *member_ptr=(*memIter).second;
+      if(member_ptr->extent_table.empty())
+	{
+	  empty_members.push_back(member_ptr);
+	}
+      else
+	{
+	  parents.insert(member_ptr->parent);
+	}
+    }
+  for(size_t i=0; i<empty_members.size(); i++)
+    {
+      member_table.remove(empty_members[i]);
+      delete empty_members[i];
+    }
+
+  std::vector<CCCC_UseRelationship*> empty_userels;
+  CCCC_Table<CCCC_UseRelationship>::iterator useIter;
+  for(useIter=userel_table.begin(); useIter!=userel_table.end(); ++useIter)
+    {
+      if((*useIter).second->extent_table.empty())
+	{
+	  empty_userels.push_back((*useIter).second);
+	}
+    }
+  for(size_t i=0; i<empty_userels.size(); i++)
+    {
+      userel_table.remove(empty_userels[i]);
+      delete empty_userels[i];
+    }
+
+  std::vector<CCCC_Module*> empty_modules;
+  CCCC_Table<CCCC_Module>::iterator modIter;
+  for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
+    {
+      CCCC_Module *module_ptr=(*modIter).second;
+      if(module_ptr->extent_table.empty() && parents.count(module_ptr)==0)
+	{
+	  empty_modules.push_back(module_ptr);
+	}
+    }
+  for(size_t i=0; i<empty_modules.size(); i++)
+    {
+      module_table.remove(empty_modules[i]);
+      delete empty_modules[i];
+    }
+}
+
+// moves the extents in a list which came from the listed files
+// into the blocks of those files, keeping them in the same order
+static void rekey_list(CCCC_ExtentList& list,
+		       const std::map<string,unsigned int>& file_blocks,
+		       unsigned int& position)
+{
+  CCCC_ExtentList::iterator extIter;
+  for(extIter=list.begin(); extIter!=list.end(); ++extIter)
+    {
+      std::map<string,unsigned int>::const_iterator blockIter=
+	file_blocks.find(extIter->name(nlFILENAME));
+      if(blockIter!=file_blocks.end())
+	{
+	  extIter->set_key((*blockIter).second,++position);
+	}
+    }
+  list.sort();
+}
+
+void CCCC_Project::rekey_extents(const std::map<string,unsigned int>& file_blocks)
+{
+  // The extents of each record were loaded in order, and the position 
+  // only ever increases, so the extents from each file keep their order 
+  // within each record, just as they were when the file was parsed.
+  unsigned int position=0;
+  CCCC_Table<CCCC_Module>::iterator modIter;
+  for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
+    {
+      rekey_list((*modIter).second->extent_table,file_blocks,position);
+    }
+  CCCC_Table<CCCC_Member>::iterator memIter;
+  for(memIter=member_table.begin(); memIter!=member_table.end(); ++memIter)
+    {
+      rekey_list((*memIter).second->extent_table,file_blocks,position);
+    }
+  CCCC_Table<CCCC_UseRelationship>::iterator useIter;
+  for(useIter=userel_table.begin(); useIter!=userel_table.end(); ++useIter)
+    {
+      rekey_list((*useIter).second->extent_table,file_blocks,position);
+    }
+  rekey_list(rejected_extent_table,file_blocks,position);
+
+  // the file extent table holds the keys the extents had before
+  file_extent_table.clear();
+}
+
+int CCCC_Project::get_count(MetricId count_id)
 {
   int retval=0;
-  retval+=module_table.get_count(count_tag);
-  retval+=rejected_extent_table.get_count(count_tag);
+  retval+=module_table.get_count(count_id);
+  retval+=rejected_extent_table.get_count(count_id);
   return retval;
 }
 
@@ -320,36 +883,59 @@ int CCCC_Project::ToFile(ofstream& ofstr)
   // STL output iterators, and one day will be ...
 
   int retval=FALSE;
-  CCCC_Module *module_ptr=module_table.first_item();
-  while(module_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter;
+  for(modIter=module_table.begin(); modIter!=module_table.end(); ++modIter)
     {
-      module_ptr->ToFile(ofstr);
-      module_ptr=module_table.next_item();
+      (*modIter).second->ToFile(ofstr);
     }
 
-  CCCC_Member *member_ptr=member_table.first_item();
-  while(member_ptr!=NULL)
+  CCCC_Table<CCCC_Member>::iterator memIter;
+  for(memIter=member_table.begin(); memIter!=member_table.end(); ++memIter)
     {
-      member_ptr->ToFile(ofstr);
-      member_ptr=member_table.next_item();
+      (*memIter).second->ToFile(ofstr);
     }
 
-  CCCC_UseRelationship *userel_ptr=userel_table.first_item();
-  while(userel_ptr!=NULL)
+  CCCC_Table<CCCC_UseRelationship>::iterator useIter;
+  for(useIter=userel_table.begin(); useIter!=userel_table.end(); ++useIter)
     {
-      userel_ptr->ToFile(ofstr);
-      userel_ptr=userel_table.next_item();
+      (*useIter).second->ToFile(ofstr);
     }
 
-  CCCC_Extent *rejext_ptr=rejected_extent_table.first_item();
-  while(rejext_ptr!=NULL)
+  CCCC_ExtentList::iterator rejIter;
+  for(rejIter=rejected_extent_table.begin(); 
+      rejIter!=rejected_extent_table.end(); 
+      ++rejIter)
     {
       CCCC_Item extent_line;
       extent_line.Insert(REJEXT_PREFIX);
-      rejext_ptr->AddToItem(extent_line);
+      rejIter->AddToItem(extent_line);
       extent_line.ToFile(ofstr);
+    }
+
+  FileCostTable::iterator costIter;
+  for(costIter=file_cost_table.begin(); 
+      costIter!=file_cost_table.end(); 
+      ++costIter)
+    {
+      CCCC_Item cost_line;
+      cost_line.Insert(FILECOST_PREFIX);
+      cost_line.Insert((*costIter).first);
+      cost_line.Insert((*costIter).second.tokens);
+      cost_line.Insert((*costIter).second.parse_usec);
+      cost_line.Insert((*costIter).second.bytes);
+      cost_line.ToFile(ofstr);
+    }
 
-      rejext_ptr=rejected_extent_table.next_item();
+  FileHashTable::iterator hashIter;
+  for(hashIter=file_hash_table.begin(); 
+      hashIter!=file_hash_table.end(); 
+      ++hashIter)
+    {
+      CCCC_Item hash_line;
+      hash_line.Insert(FILEHASH_PREFIX);
+      hash_line.Insert((*hashIter).first);
+      hash_line.Insert((*hashIter).second);
+      hash_line.ToFile(ofstr);
     }
 
   if(ofstr.good())
@@ -366,6 +952,8 @@ int CCCC_Project::FromFile(ifstream& ifstr)
   int retval=FALSE;
 
   set_active_project(this);
+  current_loading_project=this;
+  uncache_counts();
 
   while(PeekAtNextLinePrefix(ifstr,MODULE_PREFIX))
     {
@@ -390,21 +978,71 @@ int CCCC_Project::FromFile(ifstream& ifstr)
 
   while(PeekAtNextLinePrefix(ifstr,REJEXT_PREFIX))
     {
-      CCCC_Extent *new_rejext=new CCCC_Extent;
+      CCCC_Extent new_rejext;
+      CCCC_Item next_line;
+      next_line.FromFile(ifstr);
+      ifstr_line++;
+      string line_keyword_dummy;
+      if(
+	 !next_line.Extract(line_keyword_dummy) ||
+	 !new_rejext.GetFromItem(next_line) ||
+	 !rejected_extent_table.insert(new_rejext)
+	 )
+	{
+	  cerr << "Import error " << RECORD_ERROR 
+	       << " at line " << ifstr_line 
+	       << " for " << new_rejext.name(nlGLOBAL)
+	       << endl;
+	}
+    }
+
+  while(PeekAtNextLinePrefix(ifstr,FILECOST_PREFIX))
+    {
       CCCC_Item next_line;
       next_line.FromFile(ifstr);
-      int fromfile_status=RECORD_ERROR;
+      ifstr_line++;
+      string line_keyword_dummy, filename;
+      FileCost cost;
       if(
-	 new_rejext->GetFromItem(next_line) &&
-	 new_rejext==rejected_extent_table.find_or_insert(new_rejext)
+	 next_line.Extract(line_keyword_dummy) &&
+	 next_line.Extract(filename) &&
+	 next_line.Extract(cost.tokens) &&
+	 next_line.Extract(cost.parse_usec) &&
+	 next_line.Extract(cost.bytes)
 	 )
 	{
-	  fromfile_status=RECORD_ADDED;
+	  file_cost_table[filename]=cost;
+	}
+      else
+	{
+	  cerr << "Import error at line " << ifstr_line 
+	       << " for file cost record" << endl;
+	}
+    }
+
+  while(PeekAtNextLinePrefix(ifstr,FILEHASH_PREFIX))
+    {
+      CCCC_Item next_line;
+      next_line.FromFile(ifstr);
+      ifstr_line++;
+      string line_keyword_dummy, filename, hash;
+      if(
+	 next_line.Extract(line_keyword_dummy) &&
+	 next_line.Extract(filename) &&
+	 next_line.Extract(hash)
+	 )
+	{
+	  file_hash_table[filename]=hash;
+	}
+      else
+	{
+	  cerr << "Import error at line " << ifstr_line 
+	       << " for file hash record" << endl;
 	}
-      DisposeOfImportRecord(new_rejext,fromfile_status);
     }
 
   set_active_project(NULL);
+  current_loading_project=NULL;
 
   return retval;
 }
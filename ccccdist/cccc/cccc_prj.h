@@ -34,6 +34,11 @@ class CCCC_UseRelationship;
 class CCCC_Extent;
 
 static const string REJEXT_PREFIX="CCCC_RejExt";
+static const string FILECOST_PREFIX="CCCC_FileCost";
+static const string FILEHASH_PREFIX="CCCC_FileHash";
+
+// the extents of the builtin types are given this in place of a filename
+static const string BUILTIN_FILENAME="<nofile>";
 
 enum RelationshipMaskElements
 {
@@ -46,6 +51,7 @@ class CCCC_Project : public CCCC_Record
 {
   friend class CCCC_Html_Stream;
   friend class CCCC_Xml_Stream;
+  friend class CCCC_Query;
   friend class CCCC_Module;
   friend class CCCC_Member;
   friend class CCCC_UseRelationship;
@@ -54,25 +60,59 @@ class CCCC_Project : public CCCC_Record
   CCCC_Table<CCCC_Module>          module_table;
   CCCC_Table<CCCC_Member>          member_table;
   CCCC_Table<CCCC_UseRelationship> userel_table;
-  CCCC_Table<CCCC_Extent>          rejected_extent_table;
+  CCCC_ExtentList                  rejected_extent_table;
+
+  // relationships which reindex() finds to be trivial are set aside
+  // here, so that they can be considered again by a later reindex
+  CCCC_Table<CCCC_UseRelationship> trivial_userel_table;
 
   std::map<string, CCCC_Item> OptionTable;
 
+  // While files are being parsed on several threads at once, the four 
+  // tables above are dealt out into hashed shards, each behind a lock of 
+  // its own, so that records from different threads can be added side by 
+  // side.  The shards are gathered back into the tables afterwards.
+  struct IngestionShards;
+  IngestionShards *shards;
+
+  // true while the modules are serving the counts cached by reindex(),
+  // which anything that changes the project must clear first
+  bool counts_cached;
+  void uncache_counts();
+
 
  public: // because MSVC++ version of STL needs it to be...
 
   // we need a record of which extents came from which files
-  // so that when we implement persistence, we can purge
-  // extent records from each file as we re-analyze it
+  // so that an incremental run can purge the extent records
+  // from each file which it re-analyzes
   struct ExtentTableEntry
   {
-    CCCC_Table<CCCC_Extent> *table_ptr;
-    CCCC_Extent *extent_ptr;
-    ExtentTableEntry() : table_ptr(NULL), extent_ptr(NULL) {}
+    CCCC_ExtentList *list_ptr;
+    unsigned long long key;
+    ExtentTableEntry() : list_ptr(NULL), key(0) {}
   };
   typedef std::multimap<string, ExtentTableEntry> FileExtentTable;
   FileExtentTable file_extent_table;
 
+  // when files are parsed in parallel, we also keep a record of how
+  // expensive each one was to parse, so that the next run can start 
+  // the most expensive files first
+  struct FileCost
+  {
+    int tokens;
+    int parse_usec;
+    int bytes;
+    FileCost() : tokens(0), parse_usec(0), bytes(0) {}
+  };
+  typedef std::map<string, FileCost> FileCostTable;
+  FileCostTable file_cost_table;
+
+  // incremental runs keep a hash of the content of each file, so that
+  // the next run can tell which files have changed since
+  typedef std::map<string, string> FileHashTable;
+  FileHashTable file_hash_table;
+
  public:
   CCCC_Project(const string& name="");
 
@@ -84,16 +124,36 @@ class CCCC_Project : public CCCC_Record
   void add_userel(CCCC_Item& use_data_line);
   void add_rejected_extent(CCCC_Item& rejected_data_line);
 
+  // between these calls the four functions above may be called from 
+  // any number of threads at once
+  void begin_concurrent_ingestion();
+  void end_concurrent_ingestion();
+
   // this function is used after loading and/or analysis
   // has been completed to (re)create the maps owned by
-  // each module of its members and relationships
-  void reindex();
+  // each module of its members and relationships, sharing
+  // the work between the given number of threads
+  void reindex(int threads=1);
+
+  // this function undoes the work of reindex(), so that the project 
+  // can be brought up to date and reindexed again
+  void unindex();
+
+  // these functions are used by an incremental run to bring the
+  // database from the previous run up to date, by purging the extents
+  // from files which have changed or gone, dropping the records left
+  // with nothing, and moving the extents which remain into the key 
+  // blocks of the files they came from
+  void index_file_extents();
+  void purge_file(const string& filename);
+  void remove_empty_records();
+  void rekey_extents(const std::map<string,unsigned int>& file_blocks);
 
   /**
-   * Sums counts matching count_tag across all modules and rejected extents
+   * Sums the count identified by count_id across all modules and rejected extents
    * @ref CCCC_Module::get_count, CCCC_Extent::get_count
    */
-  int get_count(const char *count_tag);
+  int get_count(MetricId count_id);
 
   string name(int level) const;
 
@@ -0,0 +1,195 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+// cccc_qry.cc
+
+#include "cccc_qry.h"
+
+#include <vector>
+
+#include "cccc_itm.h"
+#include "cccc_db.h"
+
+// the counts reported for each module, as in the module detail reports
+static const MetricId module_counts[] =
+{
+  miLOC, miMVG, miCOM,
+  miWMC1, miWMCv, miDIT, miNOC, miCBO,
+  miFO, miFOv, miFOc,
+  miFI, miFIv, miFIc,
+  miIF4, miIF4v, miIF4c,
+  miLAST
+};
+
+// and for each member
+static const MetricId member_counts[] =
+{
+  miLOC, miMVG, miCOM,
+  miLAST
+};
+
+static void put_line(CCCC_Item& line, ostream& reply)
+{
+  reply << line.Text() << "\n";
+}
+
+void CCCC_Query::Error(const string& message, ostream& reply)
+{
+  CCCC_Item error_line;
+  error_line.Insert("ERROR");
+  error_line.Insert(message);
+  put_line(error_line,reply);
+  reply << "\n";
+}
+
+void CCCC_Query::Put_Module(CCCC_Module *module_ptr, ostream& reply)
+{
+  CCCC_Item module_line;
+  module_line.Insert("module");
+  module_line.Insert(module_ptr->name(nlMODULE_NAME));
+  module_line.Insert(module_ptr->name(nlMODULE_TYPE));
+  put_line(module_line,reply);
+
+  for(const MetricId *id_ptr=module_counts; *id_ptr!=miLAST; id_ptr++)
+    {
+      CCCC_Item count_line;
+      count_line.Insert(metric_definitions[*id_ptr].tag);
+      count_line.Insert(module_ptr->get_count(*id_ptr));
+      put_line(count_line,reply);
+    }
+
+  CCCC_Module::member_list_t::iterator memIter;
+  for(memIter=module_ptr->member_list.begin();
+      memIter!=module_ptr->member_list.end();
+      ++memIter)
+    {
+      CCCC_Item member_line;
+      member_line.Insert("member");
+      member_line.Insert((*memIter)->key());
+      put_line(member_line,reply);
+    }
+}
+
+void CCCC_Query::Put_Member(CCCC_Member *member_ptr, ostream& reply)
+{
+  CCCC_Item member_line;
+  member_line.Insert("member");
+  member_line.Insert(member_ptr->key());
+  put_line(member_line,reply);
+
+  for(const MetricId *id_ptr=member_counts; *id_ptr!=miLAST; id_ptr++)
+    {
+      CCCC_Item count_line;
+      count_line.Insert(metric_definitions[*id_ptr].tag);
+      count_line.Insert(member_ptr->get_count(*id_ptr));
+      put_line(count_line,reply);
+    }
+}
+
+bool CCCC_Query::Answer(CCCC_Project *prj, const string& query,
+			CCCC_Item& request, ostream& reply)
+{
+  bool retval=true;
+  string name;
+  request.Extract(name);
+
+  if(query=="modules")
+    {
+      CCCC_Item ok_line;
+      ok_line.Insert("OK");
+      put_line(ok_line,reply);
+
+      CCCC_Table<CCCC_Module>::iterator modIter;
+      for(modIter=prj->module_table.begin();
+	  modIter!=prj->module_table.end();
+	  ++modIter)
+	{
+	  CCCC_Module *module_ptr=(*modIter).second;
+	  if(module_ptr->is_trivial()==FALSE)
+	    {
+	      CCCC_Item module_line;
+	      module_line.Insert("module");
+	      module_line.Insert(module_ptr->name(nlMODULE_NAME));
+	      module_line.Insert(module_ptr->name(nlMODULE_TYPE));
+	      put_line(module_line,reply);
+	    }
+	}
+      reply << "\n";
+    }
+  else if(query=="module")
+    {
+      CCCC_Module *module_ptr=prj->module_table.find(name);
+      if(module_ptr==NULL)
+	{
+	  Error("no module named "+name,reply);
+	}
+      else
+	{
+	  CCCC_Item ok_line;
+	  ok_line.Insert("OK");
+	  put_line(ok_line,reply);
+	  Put_Module(module_ptr,reply);
+	  reply << "\n";
+	}
+    }
+  else if(query=="member")
+    {
+      // A member is named as it is in the database, with its module and
+      // parameter list.  If the parameter list is left off, every
+      // overload is reported.
+      std::vector<CCCC_Member*> members;
+      CCCC_Member *member_ptr=prj->member_table.find(name);
+      if(member_ptr!=NULL)
+	{
+	  members.push_back(member_ptr);
+	}
+      else if(name.size()>0 && name[name.size()-1]!=')')
+	{
+	  string prefix=name+"(";
+	  CCCC_Table<CCCC_Member>::iterator memIter;
+	  for(memIter=prj->member_table.lower_bound(prefix);
+	      memIter!=prj->member_table.end() &&
+		(*memIter).first.compare(0,prefix.size(),prefix)==0;
+	      ++memIter)
+	    {
+	      members.push_back((*memIter).second);
+	    }
+	}
+
+      if(members.empty())
+	{
+	  Error("no member named "+name,reply);
+	}
+      else
+	{
+	  CCCC_Item ok_line;
+	  ok_line.Insert("OK");
+	  put_line(ok_line,reply);
+	  for(size_t i=0; i<members.size(); i++)
+	    {
+	      Put_Member(members[i],reply);
+	    }
+	  reply << "\n";
+	}
+    }
+  else
+    {
+      retval=false;
+    }
+  return retval;
+}
@@ -0,0 +1,67 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+/*
+ * cccc_qry.h
+ *
+ * answers to queries about the metrics of a project held in memory
+ */
+#ifndef CCCC_QRY_H
+#define CCCC_QRY_H
+
+#include <iostream>
+#include <string>
+
+#include "cccc.h"
+
+using std::ostream;
+using std::string;
+
+class CCCC_Item;
+class CCCC_Project;
+class CCCC_Module;
+class CCCC_Member;
+
+// CCCC_Query answers the requests made of a resident cccc about the
+// project it holds, which must have been reindexed.  Requests and
+// replies are made up of lines of '@'-delimited fields, as in the
+// database.  A request is a single line whose first field names the
+// query, and the reply starts with a line which is either OK@ or
+// ERROR@ followed by a message, and ends with an empty line.
+//
+//   modules@                 the names of the non-trivial modules
+//   module@<name>@           the metrics of a module, and the names
+//                            of its members
+//   member@<name>@           the metrics of a member, named as in the
+//                            database, e.g. Stack::push(int); if the
+//                            name has no parameter list, of every
+//                            member of that name
+class CCCC_Query
+{
+  static void Put_Module(CCCC_Module *module_ptr, ostream& reply);
+  static void Put_Member(CCCC_Member *member_ptr, ostream& reply);
+
+ public:
+  // Answer returns false if the query is not one of those above, in
+  // which case nothing is written to the reply.
+  static bool Answer(CCCC_Project *prj, const string& query,
+		     CCCC_Item& request, ostream& reply);
+  static void Error(const string& message, ostream& reply);
+};
+
+#endif // CCCC_QRY_H
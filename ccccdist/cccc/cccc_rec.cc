@@ -62,15 +62,35 @@ void CCCC_Record::merge_flags(string& new_flags)
 
 void CCCC_Record::add_extent(CCCC_Item& is)
 {
-  CCCC_Extent *new_extent=new CCCC_Extent;
-  new_extent->GetFromItem(is);
-  CCCC_Extent *inserted_extent=extent_table.find_or_insert(new_extent);
-  if(new_extent != inserted_extent)
+  CCCC_Extent new_extent;
+  new_extent.GetFromItem(is);
+  extent_table.insert(new_extent);
+}
+
+bool CCCC_Record::has_equivalent_extent(const CCCC_Extent& extent)
+{
+  bool retval=false;
+  Extent_Table::iterator eIter;
+  for(eIter=extent_table.begin(); eIter!=extent_table.end(); ++eIter)
     {
-      delete new_extent;
+      if(eIter->is_equivalent(extent))
+	{
+	  retval=true;
+	  break;
+	}
     }
+  return retval;
 }
 
+unsigned long long CCCC_Record::first_extent_key() const
+{
+  unsigned long long retval=0;
+  if(extent_table.begin()!=extent_table.end())
+    {
+      retval=extent_table.begin()->get_key();
+    }
+  return retval;
+}
 
 string CCCC_Record::name(int /* level */) const { return ""; }
 string CCCC_Record::key() const { return name(nlRANK); }
@@ -41,7 +41,7 @@ class CCCC_Record
   friend class CCCC_Xml_Stream;
   static CCCC_Project *active_project;
  protected:
-  typedef CCCC_Table<CCCC_Extent> Extent_Table;
+  typedef CCCC_ExtentList Extent_Table;
   Extent_Table extent_table;
   string flags;
   virtual void merge_flags(string& new_flags);
@@ -52,8 +52,12 @@ class CCCC_Record
   AugmentedBool get_flag(PSFlag psf) { return (AugmentedBool) flags[psf]; }
 
   virtual void add_extent(CCCC_Item&);
+  bool has_equivalent_extent(const CCCC_Extent& extent);
+
+  // key of the earliest extent held, or 0 if there are none
+  unsigned long long first_extent_key() const;
   virtual void sort() { extent_table.sort(); }
-  virtual int get_count(const char *count_tag)=0;
+  virtual int get_count(MetricId count_id)=0;
   friend int rank_by_string(const void *p1, const void *p2);
   static CCCC_Project* get_active_project();
   static void set_active_project(CCCC_Project* prj);
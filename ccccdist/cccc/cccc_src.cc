@@ -0,0 +1,452 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+// cccc_src.cc
+
+#include "cccc_src.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+bool CCCC_SourceBuffer::ReadFile(const string& filename, string& text)
+{
+  if(CCCC_GitSource::installed!=NULL)
+    {
+      return CCCC_GitSource::installed->Read(filename,text);
+    }
+
+  FILE *f=fopen(filename.c_str(),"r");
+  if(f==NULL)
+    {
+      return false;
+    }
+#ifndef _WIN32
+  posix_fadvise(fileno(f),0,0,POSIX_FADV_SEQUENTIAL);
+#endif
+
+  char buffer[65536];
+  size_t chars_read;
+  while((chars_read=fread(buffer,1,sizeof(buffer),f))>0)
+    {
+      text.append(buffer,chars_read);
+    }
+  bool retval=(ferror(f)==0);
+  fclose(f);
+  return retval;
+}
+
+CCCC_SourcePrefetcher::CCCC_SourcePrefetcher(
+  const std::vector<string>& _filenames, 
+  size_t _window_files, size_t _window_bytes)
+  : filenames(_filenames), entries(_filenames.size()),
+    window_files(_window_files), window_bytes(_window_bytes),
+    files_held(0), bytes_held(0), stopping(false)
+{
+  if(window_files<1)
+    {
+      window_files=1;
+    }
+  reader=std::thread(&CCCC_SourcePrefetcher::ReadAhead,this);
+}
+
+CCCC_SourcePrefetcher::~CCCC_SourcePrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(window_mutex);
+    stopping=true;
+  }
+  window_changed.notify_all();
+  reader.join();
+}
+
+void CCCC_SourcePrefetcher::ReadAhead()
+{
+  for(size_t i=0; i<filenames.size(); i++)
+    {
+      // While we wait for room in the window, the kernel can at least
+      // be getting on with reading the files we will want next.
+      size_t expected_bytes=0;
+      struct stat file_status;
+      if(stat(filenames[i].c_str(),&file_status)==0)
+	{
+	  expected_bytes=file_status.st_size;
+	}
+#ifndef _WIN32
+      int hint_fd=open(filenames[i].c_str(),O_RDONLY);
+      if(hint_fd>=0)
+	{
+	  posix_fadvise(hint_fd,0,0,POSIX_FADV_WILLNEED);
+	  close(hint_fd);
+	}
+#endif
+
+      {
+	std::unique_lock<std::mutex> lock(window_mutex);
+	window_changed.wait(lock,[&]()
+			    { 
+			      return stopping ||
+				files_held==0 ||
+				(files_held<window_files && 
+				 bytes_held+expected_bytes<=window_bytes);
+			    });
+	if(stopping)
+	  {
+	    return;
+	  }
+      }
+
+      string text;
+      bool loaded=CCCC_SourceBuffer::ReadFile(filenames[i],text);
+
+      {
+	std::lock_guard<std::mutex> lock(window_mutex);
+	if(loaded)
+	  {
+	    files_held++;
+	    bytes_held+=text.size();
+	    entries[i].text.swap(text);
+	    entries[i].state=entry::LOADED;
+	  }
+	else
+	  {
+	    entries[i].state=entry::FAILED;
+	  }
+      }
+      window_changed.notify_all();
+    }
+}
+
+bool CCCC_SourcePrefetcher::Take(size_t i, string& text)
+{
+  bool retval=false;
+  {
+    std::unique_lock<std::mutex> lock(window_mutex);
+    window_changed.wait(lock,[&]()
+			{ return entries[i].state!=entry::WAITING; });
+    if(entries[i].state==entry::LOADED)
+      {
+	files_held--;
+	bytes_held-=entries[i].text.size();
+	text.swap(entries[i].text);
+	string().swap(entries[i].text);
+	retval=true;
+      }
+    entries[i].state=entry::TAKEN;
+  }
+  window_changed.notify_all();
+  return retval;
+}
+
+CCCC_GitSource *CCCC_GitSource::installed=NULL;
+
+#ifndef _WIN32
+// this starts git with the given arguments, with its output, and its
+// input if asked for, connected to pipes, and returns its process id
+static int start_git(const std::vector<string>& args, 
+		     int *input_fd, int *output_fd)
+{
+  int to_git[2]={-1,-1};
+  int from_git[2]={-1,-1};
+  if((input_fd!=NULL && pipe(to_git)!=0) || pipe(from_git)!=0)
+    {
+      return -1;
+    }
+
+  int pid=fork();
+  if(pid==0)
+    {
+      if(input_fd!=NULL)
+	{
+	  dup2(to_git[0],0);
+	  close(to_git[0]);
+	  close(to_git[1]);
+	}
+      dup2(from_git[1],1);
+      close(from_git[0]);
+      close(from_git[1]);
+
+      std::vector<char*> argv;
+      for(size_t i=0; i<args.size(); i++)
+	{
+	  argv.push_back(const_cast<char*>(args[i].c_str()));
+	}
+      argv.push_back(NULL);
+      execvp(argv[0],&argv[0]);
+      _exit(127);
+    }
+
+  // the ends we keep are not passed on to any other child
+  if(input_fd!=NULL)
+    {
+      close(to_git[0]);
+      fcntl(to_git[1],F_SETFD,FD_CLOEXEC);
+      *input_fd=to_git[1];
+    }
+  close(from_git[1]);
+  fcntl(from_git[0],F_SETFD,FD_CLOEXEC);
+  *output_fd=from_git[0];
+  if(pid<0)
+    {
+      if(input_fd!=NULL)
+	{
+	  close(*input_fd);
+	}
+      close(*output_fd);
+    }
+  return pid;
+}
+#endif
+
+CCCC_GitSource::CCCC_GitSource(const string& _revision)
+  : revision(_revision), pid(-1), requests(NULL), replies(NULL)
+{
+#ifndef _WIN32
+  std::vector<string> args;
+  args.push_back("git");
+  args.push_back("cat-file");
+  args.push_back("--batch");
+  int input_fd, output_fd;
+  pid=start_git(args,&input_fd,&output_fd);
+  if(pid>0)
+    {
+      requests=fdopen(input_fd,"w");
+      replies=fdopen(output_fd,"r");
+    }
+#endif
+}
+
+CCCC_GitSource::~CCCC_GitSource()
+{
+#ifndef _WIN32
+  // git stops when it sees the end of its input
+  if(requests!=NULL)
+    {
+      fclose(requests);
+    }
+  if(replies!=NULL)
+    {
+      fclose(replies);
+    }
+  if(pid>0)
+    {
+      waitpid(pid,NULL,0);
+    }
+#endif
+}
+
+bool CCCC_GitSource::Read(const string& path, string& text)
+{
+  // A path is looked up relative to the current directory, which git
+  // does for a path which starts with ./ or ../
+  if(!good() || path.size()==0 || path[0]=='/' || 
+     path.find('\n')!=string::npos)
+    {
+      return false;
+    }
+  string object=revision+":";
+  if(path.compare(0,2,"./")!=0 && path.compare(0,3,"../")!=0)
+    {
+      object+="./";
+    }
+  object+=path;
+
+  std::lock_guard<std::mutex> lock(pipe_mutex);
+  fprintf(requests,"%s\n",object.c_str());
+  fflush(requests);
+
+  // The reply is a line giving the object's name, type and size, then
+  // the object itself and a newline, or a line saying the object is 
+  // missing, which we can tell from the first because its first field 
+  // will not be a hash.
+  string header;
+  int c;
+  while((c=getc(replies))!=EOF && c!='\n')
+    {
+      header+=static_cast<char>(c);
+    }
+  size_t type_pos=header.find(' ');
+  size_t size_pos=(type_pos==string::npos) ? 
+    string::npos : header.find(' ',type_pos+1);
+  if(c==EOF || type_pos<40 || size_pos==string::npos ||
+     header.find_first_not_of("0123456789abcdef")!=type_pos)
+    {
+      return false;
+    }
+  string type=header.substr(type_pos+1,size_pos-type_pos-1);
+  size_t size=strtoul(header.c_str()+size_pos+1,NULL,10);
+
+  string content(size,'\0');
+  bool retval=(size==0 || fread(&content[0],1,size,replies)==size);
+  getc(replies);
+  if(retval && type=="blob")
+    {
+      text.append(content);
+    }
+  else
+    {
+      retval=false;
+    }
+  return retval;
+}
+
+bool CCCC_GitSource::Run(const std::vector<string>& args, string& output)
+{
+  bool retval=false;
+#ifndef _WIN32
+  int output_fd;
+  int run_pid=start_git(args,NULL,&output_fd);
+  if(run_pid<0)
+    {
+      return false;
+    }
+
+  char buffer[65536];
+  ssize_t length;
+  while((length=read(output_fd,buffer,sizeof(buffer)))!=0)
+    {
+      if(length>0)
+	{
+	  output.append(buffer,length);
+	}
+      else if(errno!=EINTR)
+	{
+	  break;
+	}
+    }
+  close(output_fd);
+
+  int status=0;
+  waitpid(run_pid,&status,0);
+  retval=(WIFEXITED(status) && WEXITSTATUS(status)==0);
+#endif
+  return retval;
+}
+
+bool CCCC_GitSource::ListFiles(std::vector<string>& paths) const
+{
+  std::vector<string> args;
+  args.push_back("git");
+  args.push_back("ls-tree");
+  args.push_back("-r");
+  args.push_back("-z");
+  args.push_back("--name-only");
+  args.push_back(revision);
+  string listing;
+  bool retval=Run(args,listing);
+
+  // the names are separated by NULs
+  size_t start=0, end;
+  while(retval && (end=listing.find('\0',start))!=string::npos)
+    {
+      paths.push_back(listing.substr(start,end-start));
+      start=end+1;
+    }
+  return retval;
+}
+
+bool CCCC_GitSource::DiffFiles(const string& from_revision,
+			       const string& to_revision,
+			       std::map<string,char>& file_status)
+{
+  std::vector<string> args;
+  args.push_back("git");
+  args.push_back("diff");
+  args.push_back("--name-status");
+  args.push_back("--no-renames");
+  args.push_back("-z");
+  args.push_back(from_revision);
+  if(to_revision!="")
+    {
+      args.push_back(to_revision);
+    }
+  args.push_back("--");
+  string listing;
+  bool retval=Run(args,listing);
+
+  // each status letter and path is followed by a NUL
+  size_t start=0, status_end, path_end;
+  while(retval && 
+	(status_end=listing.find('\0',start))!=string::npos &&
+	(path_end=listing.find('\0',status_end+1))!=string::npos)
+    {
+      file_status[listing.substr(status_end+1,path_end-status_end-1)]=
+	listing[start];
+      start=path_end+1;
+    }
+  return retval;
+}
+
+bool CCCC_GitSource::CurrentPrefix(string& prefix)
+{
+  std::vector<string> args;
+  args.push_back("git");
+  args.push_back("rev-parse");
+  args.push_back("--show-prefix");
+  prefix="";
+  bool retval=Run(args,prefix);
+  while(prefix.size()>0 && prefix[prefix.size()-1]=='\n')
+    {
+      prefix.erase(prefix.size()-1);
+    }
+  return retval;
+}
+
+string CCCC_GitSource::TopLevelPath(const string& prefix, const string& path)
+{
+  // the path is appended to the prefix, and any . or .. is taken out
+  std::vector<string> parts;
+  string whole=prefix+path;
+  size_t start=0;
+  while(start<=whole.size())
+    {
+      size_t end=whole.find('/',start);
+      if(end==string::npos)
+	{
+	  end=whole.size();
+	}
+      string part=whole.substr(start,end-start);
+      if(part==".." && parts.size()>0)
+	{
+	  parts.pop_back();
+	}
+      else if(part.size()>0 && part!=".")
+	{
+	  parts.push_back(part);
+	}
+      start=end+1;
+    }
+
+  string retval;
+  for(size_t i=0; i<parts.size(); i++)
+    {
+      if(i>0)
+	{
+	  retval+="/";
+	}
+      retval+=parts[i];
+    }
+  return retval;
+}
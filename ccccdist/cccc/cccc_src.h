@@ -0,0 +1,153 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+/*
+ * cccc_src.h
+ * 
+ * classes supporting the reading of source files into memory ahead
+ * of the parsers which will need them
+ */
+#ifndef CCCC_SRC_H
+#define CCCC_SRC_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "cccc.h"
+#include "DLexerBase.h"
+
+using std::string;
+
+// CCCC_SourceBuffer presents the text of a source file which is held in 
+// memory to the DLG lexers, in the same way as DLGFileInput presents an 
+// open file.  Unlike DLGStringInput, it does not stop at a NUL character.
+class CCCC_SourceBuffer : public DLGInputStream
+{
+  const string& text;
+  size_t pos;
+ public:
+  CCCC_SourceBuffer(const string& source_text) : text(source_text), pos(0) {}
+  int nextChar() 
+    {
+      if(pos<text.size()) 
+	{
+	  return (unsigned char) text[pos++];
+	}
+      return EOF;
+    }
+
+  // this reads the whole of a file into a string, from the git 
+  // revision being analyzed if there is one
+  static bool ReadFile(const string& filename, string& text);
+};
+
+// CCCC_SourcePrefetcher reads a list of files into memory on a 
+// background thread, working ahead of the consumers which take them 
+// in order.  The number of files and the number of bytes held in memory 
+// at any one time are both limited, although a single file which is 
+// larger than the byte limit will still be read when the window is 
+// otherwise empty.
+class CCCC_SourcePrefetcher
+{
+  struct entry
+  {
+    enum { WAITING, LOADED, FAILED, TAKEN } state;
+    string text;
+    entry() : state(WAITING) {}
+  };
+
+  std::vector<string> filenames;
+  std::vector<entry> entries;
+  size_t window_files;
+  size_t window_bytes;
+  size_t files_held, bytes_held;
+  bool stopping;
+
+  std::mutex window_mutex;
+  std::condition_variable window_changed;
+  std::thread reader;
+
+  void ReadAhead();
+
+ public:
+  CCCC_SourcePrefetcher(const std::vector<string>& filenames, 
+			size_t window_files, size_t window_bytes);
+  ~CCCC_SourcePrefetcher();
+
+  // Take takes the text of the i'th file in the list, waiting until
+  // it has been read if necessary.  It returns false if the file
+  // could not be read, in which case the caller should report the 
+  // problem in its usual way.  Each file may only be taken once.
+  bool Take(size_t i, string& text);
+};
+
+// CCCC_GitSource reads files from one revision of a local git repository
+// through a single 'git cat-file --batch' process, so that the revision
+// can be analyzed without being checked out.  Paths are taken relative 
+// to the current directory, as git itself takes them.  While a source 
+// is installed, CCCC_SourceBuffer::ReadFile reads from it rather than 
+// from the file system.
+class CCCC_GitSource
+{
+  string revision;
+  int pid;
+  FILE *requests;
+  FILE *replies;
+  std::mutex pipe_mutex;
+
+  static CCCC_GitSource *installed;
+  friend class CCCC_SourceBuffer;
+
+  // this runs git to completion, collecting its output
+  static bool Run(const std::vector<string>& args, string& output);
+
+ public:
+  CCCC_GitSource(const string& revision);
+  ~CCCC_GitSource();
+
+  // false if git could not be started
+  bool good() const { return requests!=NULL && replies!=NULL; }
+
+  // this returns false if the path is not a file in the revision
+  bool Read(const string& path, string& text);
+
+  // this lists the files in the revision below the current directory
+  bool ListFiles(std::vector<string>& paths) const;
+
+  static void Install(CCCC_GitSource *source) { installed=source; }
+
+  // The functions below run git in the repository holding the current
+  // directory.  DiffFiles maps the path of each file which differs 
+  // between one revision and another, or the working tree if the other
+  // is empty, to git's status letter for it (A, D, M or T).  Its paths,
+  // like those from TopLevelPath, are relative to the top of the 
+  // working tree, whose path from the current directory is found by 
+  // CurrentPrefix.
+  static bool DiffFiles(const string& from_revision, 
+			const string& to_revision,
+			std::map<string,char>& file_status);
+  static bool CurrentPrefix(string& prefix);
+  static string TopLevelPath(const string& prefix, const string& path);
+};
+
+#endif // CCCC_SRC_H
@@ -0,0 +1,83 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+/*
+ * cccc_sym.cc
+ */
+
+#include "cccc_sym.h"
+
+#include <mutex>
+#include <unordered_map>
+
+// The strings are kept in chunks which never move, so that a string can 
+// be read without a lock while others are being added.  The table of
+// chunks is big enough for every symbol a 32 bit identifier allows.
+static const unsigned int CHUNK_BITS=16;
+static const unsigned int CHUNK_SIZE=1u<<CHUNK_BITS;
+static string *chunks[1u<<(32-CHUNK_BITS)];
+
+static std::mutex symbol_lock;
+static Symbol symbol_count=0;
+
+// the views point at the strings held in the chunks
+typedef std::unordered_map<std::string_view,Symbol> symbol_map_t;
+static symbol_map_t *symbol_map=NULL;
+
+Symbol SymbolTable::intern(std::string_view text)
+{
+  std::lock_guard<std::mutex> held(symbol_lock);
+  if(symbol_map==NULL)
+    {
+      // the empty string is always the first symbol
+      symbol_map=new symbol_map_t;
+      chunks[0]=new string[CHUNK_SIZE];
+      (*symbol_map)[chunks[0][0]]=symbol_count++;
+    }
+
+  Symbol retval;
+  symbol_map_t::iterator iter=symbol_map->find(text);
+  if(iter!=symbol_map->end())
+    {
+      retval=(*iter).second;
+    }
+  else
+    {
+      retval=symbol_count++;
+      string*& chunk=chunks[retval>>CHUNK_BITS];
+      if(chunk==NULL)
+	{
+	  chunk=new string[CHUNK_SIZE];
+	}
+      string& held_text=chunk[retval&(CHUNK_SIZE-1)];
+      held_text=text;
+      (*symbol_map)[held_text]=retval;
+    }
+  return retval;
+}
+
+const string& SymbolTable::text(Symbol symbol)
+{
+  static const string empty_text;
+  const string *retval=&empty_text;
+  if(symbol!=EMPTY)
+    {
+      retval=&chunks[symbol>>CHUNK_BITS][symbol&(CHUNK_SIZE-1)];
+    }
+  return *retval;
+}
@@ -0,0 +1,59 @@
+/*
+    CCCC - C and C++ Code Counter
+    Copyright (C) 1994-2005 Tim Littlefair (tim_littlefair@hotmail.com)
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+/*
+ * cccc_sym.h
+ *
+ * strings which are held once for the whole program
+ */
+#ifndef CCCC_SYM_H
+#define CCCC_SYM_H
+
+#include <string>
+#include <string_view>
+
+using std::string;
+
+// A Symbol stands for a string which is held once by the SymbolTable,
+// however many records refer to it.  Two symbols are equal just when
+// their strings are.  Symbols may be interned and looked up from any
+// number of threads at once, and a symbol's string stays where it is
+// until the program ends.
+typedef unsigned int Symbol;
+
+class SymbolTable
+{
+ public:
+  // the symbol of the empty string
+  static const Symbol EMPTY=0;
+
+  static Symbol intern(std::string_view text);
+  static const string& text(Symbol symbol);
+};
+
+// orders symbols as the strings they stand for are ordered, for the 
+// containers whose order shows in the reports
+struct SymbolTextLess
+{
+  bool operator()(Symbol s1, Symbol s2) const
+  {
+    return s1!=s2 && SymbolTable::text(s1)<SymbolTable::text(s2);
+  }
+};
+
+#endif // CCCC_SYM_H
@@ -28,113 +28,185 @@
 
 
 template <class T> CCCC_Table<T>::CCCC_Table()
-: sorted(true)
 {
-  iter_ = map_t::end();
 }
 
 template <class T> CCCC_Table<T>::~CCCC_Table()
 {
-  // the container should manage the destruction of its own
-  // nodes correctly, we just need to get rid of the
-  // objects to which we hold pointers.
   // NB Although CCCC_Table holds pointers, it owns the
   // objects they point to and is responsible for their disposal.
-  T* itemptr=first_item();
-  while(itemptr!=NULL)
+  typename map_t::iterator value_iterator;
+  for(value_iterator=items.begin(); 
+      value_iterator!=items.end(); 
+      ++value_iterator)
     {
-      delete itemptr;
-      itemptr=next_item();
+      delete (*value_iterator).second;
     }
 }
 
 template<class T>
-int CCCC_Table<T>::get_count(const char* count_tag)
+int CCCC_Table<T>::get_count(MetricId count_id)
 {
   int retval=0;
-  T* itemptr=first_item();
-  while(itemptr!=NULL)
+  typename map_t::iterator value_iterator=items.begin();
+  while(value_iterator!=items.end())
     {
-      retval+=itemptr->get_count(count_tag);
-      itemptr=next_item();
+      retval+=(*value_iterator).second->get_count(count_id);
+      value_iterator++;
     }
 
   return retval;
 }
 
 template<class T>
-T* CCCC_Table<T>::find(string name)
+size_t CCCC_Table<T>::hash_key(std::string_view key)
 {
-  T *retval=NULL;
-  typename map_t::iterator value_iterator=map_t::find(name);
-  if(value_iterator!=map_t::end())
+  return std::hash<std::string_view>()(key);
+}
+
+template<class T>
+void CCCC_Table<T>::index_entry(value_type *entry)
+{
+  size_t mask=index.size()-1;
+  size_t hash=hash_key(entry->first);
+  size_t i=hash&mask;
+  while(index[i].entry!=NULL)
     {
-      retval=(*value_iterator).second;
+      i=(i+1)&mask;
     }
-  return retval;
+  index[i].hash=hash;
+  index[i].entry=entry;
 }
 
 template<class T>
-T* CCCC_Table<T>::find_or_insert(T* new_item_ptr)
+void CCCC_Table<T>::unindex_entry(value_type *entry)
 {
-  string new_key=new_item_ptr->key();
-  T *retval=find(new_key);
-  if(retval==NULL)
+  size_t mask=index.size()-1;
+  size_t i=hash_key(entry->first)&mask;
+  while(index[i].entry!=entry)
     {
-      typename map_t::value_type new_pair(new_key,new_item_ptr);
-      map_t::insert(new_pair);
-      sorted=false;
-      retval=new_item_ptr;
+      i=(i+1)&mask;
+    }
+
+  // The slots after the one emptied are moved back into it where they 
+  // may, so that no search stops short at the empty slot.
+  size_t hole=i;
+  index[hole].entry=NULL;
+  for(i=(hole+1)&mask; index[i].entry!=NULL; i=(i+1)&mask)
+    {
+      size_t home=index[i].hash&mask;
+      if( ((i-home)&mask) >= ((i-hole)&mask) )
+	{
+	  index[hole]=index[i];
+	  index[i].entry=NULL;
+	  hole=i;
+	}
     }
-  return retval;
 }
 
 template<class T>
-bool CCCC_Table<T>::remove(T* old_item_ptr)
+void CCCC_Table<T>::rebuild_index()
 {
-  bool retval=false;
-  typename map_t::iterator value_iterator=map_t::find(old_item_ptr->key());
-  if(value_iterator!=map_t::end())
+  index.clear();
+  if(items.size()>=INDEX_THRESHOLD)
     {
-      this->erase(value_iterator);
-      retval=true;
+      size_t capacity=INDEX_THRESHOLD*2;
+      while(capacity<items.size()*4)
+	{
+	  capacity*=2;
+	}
+      IndexSlot empty_slot={0,NULL};
+      index.assign(capacity,empty_slot);
+      typename map_t::iterator value_iterator;
+      for(value_iterator=items.begin(); 
+	  value_iterator!=items.end(); 
+	  ++value_iterator)
+	{
+	  index_entry(&(*value_iterator));
+	}
     }
-  return retval;
 }
 
-template <class T> void CCCC_Table<T>::sort()
+template<class T>
+T* CCCC_Table<T>::find(std::string_view name) const
 {
-  if(sorted==false)
+  T *retval=NULL;
+  if(index.empty())
     {
-      sorted=true;
+      typename map_t::const_iterator value_iterator=items.find(name);
+      if(value_iterator!=items.end())
+	{
+	  retval=(*value_iterator).second;
+	}
     }
+  else
+    {
+      size_t mask=index.size()-1;
+      size_t hash=hash_key(name);
+      for(size_t i=hash&mask; index[i].entry!=NULL; i=(i+1)&mask)
+	{
+	  if(index[i].hash==hash && index[i].entry->first==name)
+	    {
+	      retval=index[i].entry->second;
+	      break;
+	    }
+	}
+    }
+  return retval;
 }
 
-template <class T> void CCCC_Table<T>::reset_iterator()
+template<class T>
+void CCCC_Table<T>::insert(const value_type& item)
 {
-  iter_=map_t::begin();
+  std::pair<typename map_t::iterator,bool> inserted=items.insert(item);
+  if(inserted.second)
+    {
+      if(index.size()<items.size()*2)
+	{
+	  rebuild_index();
+	}
+      else
+	{
+	  index_entry(&(*inserted.first));
+	}
+    }
 }
 
-template <class T> T* CCCC_Table<T>::first_item()
+template<class T>
+T* CCCC_Table<T>::find_or_insert(T* new_item_ptr)
 {
-  reset_iterator();
-  return next_item();
+  string new_key=new_item_ptr->key();
+  T *retval=find(new_key);
+  if(retval==NULL)
+    {
+      insert(value_type(new_key,new_item_ptr));
+      retval=new_item_ptr;
+    }
+  return retval;
 }
 
-template <class T> T* CCCC_Table<T>::next_item()
+template<class T>
+bool CCCC_Table<T>::remove(T* old_item_ptr)
 {
-  T* retval=NULL;
-  if(iter_!=map_t::end())
+  bool retval=false;
+  typename map_t::iterator value_iterator=items.find(old_item_ptr->key());
+  if(value_iterator!=items.end())
     {
-      retval=(*iter_).second;
-      iter_++;
+      if(!index.empty())
+	{
+	  unindex_entry(&(*value_iterator));
+	}
+      items.erase(value_iterator);
+      retval=true;
     }
   return retval;
 }
 
-template <class T> int CCCC_Table<T>::records()
+template<class T>
+void CCCC_Table<T>::clear()
 {
-  return map_t::size();
+  items.clear();
+  index.clear();
 }
 
 #endif // _CCCC_TBL_BODY
@@ -26,33 +26,92 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <map>
 
+#include "cccc_mdf.h"
+
 using std::string;
 
-// CCCC_Table started its life as an array of pointers to CCCC_Records.
-// It will ultimately become identical to a std::map from string to T*.
-// In the mean time we are supporting a legacy API.
+// CCCC_Table started its life as an array of pointers to CCCC_Records,
+// and later became a std::map from string to T*.  The records are still
+// held in a map ordered by key, which gives the reports their order, but 
+// once a table has grown beyond a handful of records it also keeps an 
+// open addressing hash index of them, so that finding a record by its 
+// key takes a single comparison of strings in most cases.
+// The table owns the records it holds, and deletes them when it goes.
+// Records are visited with the table's iterators, of which any number 
+// may be in use at once, on any number of threads, while the table is 
+// not being changed.
 template <class T> class CCCC_Table 
-: public std::map<string,T*>
 {
-  typedef std::map<string,T*> map_t;
-  typename map_t::iterator iter_;
-  bool sorted;
+ public:
+  typedef std::map<string,T*,std::less<> > map_t;
+  typedef typename map_t::iterator iterator;
+  typedef typename map_t::const_iterator const_iterator;
+  typedef typename map_t::value_type value_type;
+
+ private:
+  map_t items;
+
+  // Each slot of the index holds the hash of a key and the entry of the
+  // map which has it, or NULL.  The index is empty while the table is 
+  // smaller than INDEX_THRESHOLD, and at most half full otherwise.
+  struct IndexSlot
+  {
+    size_t hash;
+    value_type *entry;
+  };
+  std::vector<IndexSlot> index;
+  enum { INDEX_THRESHOLD=16 };
+
+  static size_t hash_key(std::string_view key);
+  void index_entry(value_type *entry);
+  void unindex_entry(value_type *entry);
+  void rebuild_index();
+
+  // the table owns its records, so it may not be copied
+  CCCC_Table(const CCCC_Table&);
+  CCCC_Table& operator=(const CCCC_Table&);
 
  public:
   CCCC_Table();
   virtual ~CCCC_Table();
-  int records();
-  T* find(string name);
+  int records() const { return items.size(); }
+  size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+
+  iterator begin() { return items.begin(); }
+  iterator end() { return items.end(); }
+  const_iterator begin() const { return items.begin(); }
+  const_iterator end() const { return items.end(); }
+
+  // the first record whose key is not less than the one given
+  iterator lower_bound(std::string_view key) { return items.lower_bound(key); }
+
+  // The name may be given as any kind of string, and is not copied.
+  T* find(std::string_view name) const;
   T* find_or_insert(T* new_item_ptr);
   bool remove(T* old_item_ptr);
-  void reset_iterator();
-  T* first_item();
-  T* next_item();
-  virtual int get_count(const char *count_tag);
-  void sort();
+
+  // these move records between tables without deleting them
+  void insert(const value_type& item);
+  template <class InputIterator> 
+    void insert(InputIterator first, InputIterator last)
+    {
+      for( ; first!=last; ++first)
+	{
+	  insert(*first);
+	}
+    }
+  void clear();
+
+  virtual int get_count(MetricId count_id);
+
+  // the table is always kept in order of key
+  void sort() {}
 };
 
 #include "cccc_tbl.cc"
@@ -26,12 +26,13 @@
 #include "cccc_tok.h"
 
 /* static variables */
-int ANTLRToken::RunningNesting=0;
-int ANTLRToken::bCodeLine=0;
+thread_local int ANTLRToken::RunningNesting=0;
+thread_local int ANTLRToken::bCodeLine=0;
+thread_local int ANTLRToken::RunningTokenCount=0;
 int ANTLRToken::numAllocated=0;
-int toks_alloc1=0, toks_alloc2=0, toks_alloc3=0, toks_freed=0;
+thread_local int toks_alloc1=0, toks_alloc2=0, toks_alloc3=0, toks_freed=0;
 
-ANTLRToken currentLexerToken;
+thread_local ANTLRToken currentLexerToken;
 
 /*
 ** Token objects are used to count the occurences of states which
@@ -154,6 +155,7 @@ void ANTLRToken::CountToken()
 {
   // we have seen a non-skippable pattern => this line counts toward LOC
   bCodeLine=1;
+  RunningTokenCount++;
   CurrentNesting=RunningNesting;
   DbgMsg(COUNTER,cerr,*this);
 }
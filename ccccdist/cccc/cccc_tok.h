@@ -55,14 +55,19 @@ class ANTLRToken : public ANTLRCommonToken {
   // in the region's extent.
 
   // nesting levels are used to control resynchronisation
-  static int RunningNesting;
+  // The running state of the lexer is kept per thread, as each thread
+  // parsing a file has a lexer of its own.
+  static thread_local int RunningNesting;
 
   static int numAllocated;
   int CurrentNesting;
   friend ostream& operator << (ostream&,ANTLRToken&);
   friend class DLGLexer;
  public:
-  static int bCodeLine;
+  static thread_local int bCodeLine;
+
+  // the number of tokens lexed since the running state was last reset
+  static thread_local int RunningTokenCount;
 
   ANTLRToken(ANTLRTokenType t, ANTLRChar *s);
   ANTLRToken(ANTLRToken& copyTok);
@@ -78,6 +83,13 @@ class ANTLRToken : public ANTLRCommonToken {
   static void IncrementNesting() { RunningNesting++; }
   static void DecrementNesting() { RunningNesting--; }
 
+  // This is called before each file is lexed, so that the outcome for 
+  // a file never depends on which files were parsed before it on the
+  // same thread (e.g. unbalanced braces, or a final line without a 
+  // newline).
+  static void ResetRunningState() 
+    { RunningNesting=0; bCodeLine=0; RunningTokenCount=0; }
+
   int getNestingLevel() { return CurrentNesting; }
   void CountToken();
   const char *getTokenTypeName();
@@ -86,7 +98,7 @@ class ANTLRToken : public ANTLRCommonToken {
 #define MY_TOK(t) ((ANTLRToken*)(t))
 ostream& operator << (ostream&, ANTLRToken&);
 
-extern ANTLRToken currentLexerToken;
+extern thread_local ANTLRToken currentLexerToken;
 
 
 #endif
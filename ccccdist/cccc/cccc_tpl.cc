@@ -31,8 +31,7 @@
 
 #include "cccc_tbl.cc"
 
-template class std::map<string,Source_Anchor>;
-template class CCCC_Table<CCCC_Extent>;
+template class std::set<Source_Anchor>;
 template class CCCC_Table<CCCC_Module>;
 template class CCCC_Table<CCCC_UseRelationship>;
 template class CCCC_Table<CCCC_Member>;
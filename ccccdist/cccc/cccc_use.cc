@@ -28,6 +28,8 @@
 
 
 CCCC_UseRelationship::CCCC_UseRelationship(CCCC_Item& is)
+: supplier(SymbolTable::EMPTY), client(SymbolTable::EMPTY),
+  member(SymbolTable::EMPTY)
 {
   is.Extract(client);
   is.Extract(member);
@@ -45,17 +47,17 @@ string CCCC_UseRelationship::name(int name_level) const
     {
     case nlRANK:
     case nlSIMPLE:
-      namestr.append(client);
+      namestr.append(SymbolTable::text(client));
       namestr.append(" uses ");
-      namestr.append(supplier);
+      namestr.append(SymbolTable::text(supplier));
       break;
 
     case nlSUPPLIER:
-      namestr=supplier;
+      namestr=SymbolTable::text(supplier);
       break;
 
     case nlCLIENT:
-      namestr=client;
+      namestr=SymbolTable::text(client);
       break;
 
     default:
@@ -70,10 +72,10 @@ void CCCC_UseRelationship::add_extent(CCCC_Item& is)
   // processing is similar to the CCCC_Record method, except that we update
   // the visibility and concreteness data members
   // but do not do merge_flags
-  CCCC_Extent *new_extent=new CCCC_Extent(is);
-  CCCC_Extent *inserted_extent=extent_table.find_or_insert(new_extent);
+  CCCC_Extent new_extent(is);
+  extent_table.insert(new_extent);
 
-  switch(new_extent->get_visibility())
+  switch(new_extent.get_visibility())
     {
     case vPUBLIC:
     case vPROTECTED:
@@ -94,7 +96,7 @@ void CCCC_UseRelationship::add_extent(CCCC_Item& is)
   // types
   // the use type attached to the relationship record is used only to identify
   // inheritance relationships
-  UseType new_ut=new_extent->get_usetype();
+  UseType new_ut=new_extent.get_usetype();
   if(new_ut==utINHERITS)
     {
       ut=utINHERITS;
@@ -112,20 +114,16 @@ void CCCC_UseRelationship::add_extent(CCCC_Item& is)
       // no change required
       ;;
     }
-
-  if(new_extent != inserted_extent)
-    {
-      delete new_extent;
-    }
 }
 
-int CCCC_UseRelationship::get_count(const char* count_tag)
+int CCCC_UseRelationship::get_count(MetricId count_id)
 {
   int retval=0;
+  const MetricDefinition& definition=metric_definitions[count_id];
 
-  if( (strncmp(count_tag, COUNT_TAG_FAN_IN, 2)==0) || (strncmp(count_tag, COUNT_TAG_FAN_OUT, 2)==0) )
+  if( (definition.base==miFI) || (definition.base==miFO) )
     {
-      char suffix=count_tag[2];
+      char suffix=definition.suffix;
       switch(suffix)
 	{
 	case 0:
@@ -147,12 +145,12 @@ int CCCC_UseRelationship::get_count(const char* count_tag)
 	  break;
 
 	default:
-	  cerr << "Unexpected count tag suffix" << count_tag << endl;
+	  cerr << "Unexpected count tag suffix" << definition.tag << endl;
 	}
     }
   else
     {
-      cerr << "Unexpected count tag " << count_tag << endl;
+      cerr << "Unexpected count tag " << definition.tag << endl;
     }
 
 
@@ -163,12 +161,12 @@ int CCCC_UseRelationship::get_count(const char* count_tag)
 
 CCCC_Module* CCCC_UseRelationship::supplier_module_ptr(CCCC_Project *prj)
 {
-  return prj->module_table.find(supplier.c_str());
+  return prj->module_table.find(SymbolTable::text(supplier));
 }
 
 CCCC_Module* CCCC_UseRelationship::client_module_ptr(CCCC_Project *prj)
 {
-  return prj->module_table.find(client.c_str());
+  return prj->module_table.find(SymbolTable::text(client));
 }
 
 
@@ -178,21 +176,20 @@ int CCCC_UseRelationship::ToFile(ofstream& ofstr)
 
   CCCC_Item line;
   line.Insert(USEREL_PREFIX);
-  line.Insert(supplier);
-  line.Insert(client);
+  line.Insert(SymbolTable::text(supplier));
+  line.Insert(SymbolTable::text(client));
   line.ToFile(ofstr);
 
-  CCCC_Extent *extent_ptr=extent_table.first_item();
-  while(extent_ptr!=NULL)
+  Extent_Table::iterator extIter;
+  for(extIter=extent_table.begin(); extIter!=extent_table.end(); ++extIter)
     {
+      CCCC_Extent *extent_ptr=&*extIter;
       CCCC_Item extent_line;
       extent_line.Insert(USEEXT_PREFIX);
-      extent_line.Insert(supplier);
-      extent_line.Insert(client);
+      extent_line.Insert(SymbolTable::text(supplier));
+      extent_line.Insert(SymbolTable::text(client));
       extent_ptr->AddToItem(extent_line);
       extent_line.ToFile(ofstr);
-
-      extent_ptr=extent_table.next_item();
     }
 
   if(ofstr.good())
@@ -237,7 +234,7 @@ int CCCC_UseRelationship::FromFile(ifstream& ifstr)
       // process extent records
       while(PeekAtNextLinePrefix(ifstr,USEEXT_PREFIX))
 	{
-	  CCCC_Extent *new_extent=new CCCC_Extent;
+	  CCCC_Extent new_extent;
 	  next_line.FromFile(ifstr);
 	  ifstr_line++;
 	  string supplier_dummy, client_dummy;
@@ -246,19 +243,23 @@ int CCCC_UseRelationship::FromFile(ifstream& ifstr)
 	     next_line.Extract(line_keyword_dummy) &&
 	     next_line.Extract(supplier_dummy) &&
 	     next_line.Extract(client_dummy) &&
-	     new_extent->GetFromItem(next_line)
+	     new_extent.GetFromItem(next_line)
 	     )
 	    {
 	      // We don't ever expect to find duplicated extent records
 	      // but just in case...
-	      CCCC_Extent *found_eptr=
-		found_uptr->extent_table.find_or_insert(new_extent);
-	      if(found_eptr!=new_extent)
+	      if(!found_uptr->extent_table.insert(new_extent))
 		{
 		  cerr << "Failed to add extent for relationship "
 		       << found_uptr->key() << " at line " << ifstr_line
 		       << endl;
-		  delete new_extent;
+		}
+	      else if(new_extent.get_usetype()==utINHERITS)
+		{
+		  // the use type of the relationship is not saved, but 
+		  // is needed to recognize inheritance, so we recover 
+		  // it from the extents as add_extent does
+		  found_uptr->ut=utINHERITS;
 		}
 	    }
 	}
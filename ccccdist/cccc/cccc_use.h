@@ -34,10 +34,12 @@ enum UserelNameLevel { nlSUPPLIER=-1, nlCLIENT=-2, nlMEMBER=-3 };
 class CCCC_UseRelationship : public CCCC_Record 
 {
   friend class CCCC_Project;
-  string supplier, client, member;
+  Symbol supplier, client, member;
   UseType ut;
   AugmentedBool visible, concrete;
-  CCCC_UseRelationship() { ut=utDONTKNOW; }
+  CCCC_UseRelationship() 
+    : supplier(SymbolTable::EMPTY), client(SymbolTable::EMPTY), 
+      member(SymbolTable::EMPTY) { ut=utDONTKNOW; }
 
  public:
   string name( int index ) const;
@@ -45,7 +47,7 @@ class CCCC_UseRelationship : public CCCC_Record
   int FromFile(ifstream& infile);
   int ToFile(ofstream& outfile);
   void add_extent(CCCC_Item&);
-  int get_count(const char *count_tag);
+  int get_count(MetricId count_id);
   UseType get_usetype() const { return ut; }
   AugmentedBool is_visible () const { return visible; }
   AugmentedBool is_concrete () const { return concrete; }
@@ -34,6 +34,9 @@
 
 #include <cassert>
 #include <iomanip>
+#include <thread>
+#include <mutex>
+#include <time.h>
 using std::ios;
 //using std::trunc;
 using std::ends;
@@ -45,13 +48,8 @@ using std::resetiosflags;
 #define FS "@"
 #define RS "\n"
 
-string ParseUtility::stack_rules[MAX_STACK_DEPTH];
-int         ParseUtility::stack_tokenline[MAX_STACK_DEPTH];
-string ParseUtility::stack_tokentext[MAX_STACK_DEPTH];
-int         ParseUtility::stack_depth;
-
-ParseUtility* ParseUtility::theCurrentInstance=NULL;
-ParseStore* ParseStore::theCurrentInstance=NULL;
+thread_local ParseUtility* ParseUtility::theCurrentInstance=NULL;
+thread_local ParseStore* ParseStore::theCurrentInstance=NULL;
 
 // insertion and extraction functions intended to support enumerations
 void insert_enum(ostream& os, int e) 
@@ -86,6 +84,26 @@ istream& operator>>(istream& is, Visibility& v) {
   return is;
 }
 
+string TimeString(time_t t)
+{
+  static std::mutex ctime_mutex;
+  std::lock_guard<std::mutex> lock(ctime_mutex);
+  return ctime(&t);
+}
+
+string ContentHash(const string& text)
+{
+  unsigned long long hash=14695981039346656037ULL;
+  for(size_t i=0; i<text.size(); i++)
+    {
+      hash^=static_cast<unsigned char>(text[i]);
+      hash*=1099511628211ULL;
+    }
+  char buf[24];
+  sprintf(buf,"%016llx",hash);
+  return buf;
+}
+
 ostream& operator<<(ostream& os, UseType ut) {
   insert_enum(os,ut);
   return os;
@@ -98,8 +116,7 @@ istream& operator>>(istream& is, UseType& ut) {
 
 string ParseUtility::lookahead_text(int n)
 {
-  static string retval;
-  retval="";
+  string retval;
   int i;
   for(i=1; i<=n; i++)
     {
@@ -171,7 +188,7 @@ void ParseUtility::resynchronize(int initial_nesting,
       parser->consume();
     }
 
-  cerr << "Unrecognized section from " 
+  error_stream() << "Unrecognized section from " 
        << string1.c_str() << " on line " << line1 << " to " 
        << string2.c_str() << " on line " << line2 << endl
        << "=====ignored section begins=====" << endl
@@ -184,12 +201,15 @@ ParseUtility::ParseUtility(ANTLRParser *parser)
 {
   // This is designed as a serial-singleton class (e.g. many 
   // instances may exist over time but no more than one at a
-  // time).
-  // For the lifetime of an instance, the static member theCurrentInstance
-  // points to it. When no instance exists, this pointer is null.
+  // time on any one thread).
+  // For the lifetime of an instance, the thread-local static member 
+  // theCurrentInstance points to it. When no instance exists, this 
+  // pointer is null.
   assert(theCurrentInstance==NULL);
   theCurrentInstance=this;
 
+  error_os=&cerr;
+  error_count=0;
   trace_depth=0;
   stack_depth=0;
   this->parser=(ANTLR_Assisted_Parser*)parser;
@@ -231,16 +251,19 @@ string ParseUtility::scopeCombine(const string& baseScope, const string& name)
   return retval;
 }
 
-ParseStore::ParseStore(const string& filename)
+ParseStore::ParseStore(const string& filename, ParseRecordList *deferred_records)
 : theFilename(filename)
+, deferredRecords(deferred_records)
+, isFragment(false)
 , pendingLexicalCounts(static_cast<int>(tcLAST),0)
 , flag(static_cast<int>(psfLAST)+1,'?')
 {
   // This is designed as a serial-singleton class (e.g. many 
   // instances may exist over time but no more than one at a
-  // time).
-  // For the lifetime of an instance, the static member theCurrentInstance
-  // points to it. When no instance exists, this pointer is null.
+  // time on any one thread).
+  // For the lifetime of an instance, the thread-local static member 
+  // theCurrentInstance points to it. When no instance exists, this 
+  // pointer is null.
   assert(theCurrentInstance==NULL);
   theCurrentInstance=this;
   flag[psfLAST]='\0';
@@ -326,14 +349,7 @@ insert_extent(CCCC_Item& os, int startLine, int endLine,
       // are not already listed in the inner extent).
       lineLexicalCounts.erase(extentStartIter,extentEndIter);
 
-      ostringstream lexcount_str;
-
-      lexcount_str << "LOC:" << lexical_counts_for_this_extent[tcCODELINES]
-		   << " COM:" << lexical_counts_for_this_extent[tcCOMLINES]
-		   << " MVG:" << lexical_counts_for_this_extent[tcMCCABES_VG]
-		   << ends;
-
-      os.Insert(lexcount_str.str().c_str());
+      os.Insert(CCCC_Extent::count_text(lexical_counts_for_this_extent));
 
     }
   else
@@ -361,7 +377,7 @@ void ParseStore::record_module_extent(int startLine, int endLine,
     module_line.Insert(moduleType);
     insert_extent(module_line,startLine,endLine,
 	 description,flags(),ut,true);
-    prj->add_module(module_line);
+    commit_record(prtMODULE,module_line);
   }
 }
 
@@ -398,7 +414,7 @@ void ParseStore::record_function_extent(int startLine, int endLine,
 
     insert_extent(function_line,startLine,endLine,
      description,baseFlags,ut,true);
-    prj->add_member(function_line);
+    commit_record(prtMEMBER,function_line);
   }
 }
 
@@ -445,7 +461,7 @@ void ParseStore::record_userel_extent(int startLine, int endLine,
 	  baseFlags[psfVISIBILITY]=visibility;
 	  insert_extent(userel_line,startLine,endLine,
 			description,baseFlags,ut,record_lexcounts);
-	  prj->add_userel(userel_line);
+	  commit_record(prtUSEREL,userel_line);
    }
 }
 
@@ -454,7 +470,251 @@ void ParseStore::record_other_extent(int startLine, int endLine,
 {
   CCCC_Item rejext_line;
   insert_extent(rejext_line,startLine,endLine,description,flags(),utREJECTED,true);
-  prj->add_rejected_extent(rejext_line);
+  commit_record(prtREJEXT,rejext_line);
+}
+
+void ParseStore::record_file_scope_extent(int endLine)
+{
+  if(!isFragment)
+    {
+      record_other_extent(1,endLine,"<file scope items>");
+    }
+}
+
+void ParseStore::take_line_counts(LineCountList& counts)
+{
+  counts.insert(counts.end(),
+		lineLexicalCounts.begin(),lineLexicalCounts.end());
+  lineLexicalCounts.clear();
+}
+
+void ParseStore::add_line_counts(LineCountList::const_iterator first,
+				 LineCountList::const_iterator last)
+{
+  lineLexicalCounts.insert(first,last);
+}
+
+void ParseStore::restore_flags(const string& saved_flags)
+{
+  for(size_t i=0; i<saved_flags.size() && i<psfLAST; i++)
+    {
+      flag[i]=saved_flags[i];
+    }
+}
+
+void ParseStore::commit_records(ParseRecordList& records)
+{
+  ParseRecordList::iterator recIter;
+  for(recIter=records.begin(); recIter!=records.end(); ++recIter)
+    {
+      commit_record((*recIter).first,(*recIter).second);
+    }
+}
+
+static void add_record_to_project(ParseRecordType rt, CCCC_Item& record,
+				  CCCC_Project *project)
+{
+  switch(rt)
+    {
+    case prtMODULE:
+      project->add_module(record);
+      break;
+    case prtMEMBER:
+      project->add_member(record);
+      break;
+    case prtUSEREL:
+      project->add_userel(record);
+      break;
+    case prtREJEXT:
+      project->add_rejected_extent(record);
+      break;
+    }
+}
+
+void ParseStore::commit_record(ParseRecordType rt, CCCC_Item& record)
+{
+  if(deferredRecords!=NULL)
+    {
+      deferredRecords->push_back(ParseRecord(rt,record));
+    }
+  else
+    {
+      add_record_to_project(rt,record,prj);
+    }
+}
+
+void ParseStore::add_records_to_project(ParseRecordList& records)
+{
+  ParseRecordList::iterator recIter;
+  for(recIter=records.begin(); recIter!=records.end(); ++recIter)
+    {
+      add_record_to_project((*recIter).first,(*recIter).second,prj);
+    }
+}
+
+size_t ParseStore::filename_field(ParseRecordType rt)
+{
+  size_t retval=0;
+  switch(rt)
+    {
+    case prtMODULE:
+      retval=2;
+      break;
+    case prtMEMBER:
+      retval=4;
+      break;
+    case prtUSEREL:
+      retval=3;
+      break;
+    case prtREJEXT:
+      retval=0;
+      break;
+    }
+  return retval;
+}
+
+void ParseStore::rename_records(ParseRecordList& records, 
+				const string& filename)
+{
+  ParseRecordList::iterator recIter;
+  for(recIter=records.begin(); recIter!=records.end(); ++recIter)
+    {
+      size_t field_index=filename_field((*recIter).first);
+      CCCC_Item record;
+      string value;
+      for(size_t field=0; (*recIter).second.Extract(value); field++)
+	{
+	  if(field==field_index)
+	    {
+	      value=filename;
+	    }
+	  record.Insert(value);
+	}
+      (*recIter).second=record;
+    }
+}
+
+LexedFile::~LexedFile()
+{
+  for(size_t i=0; i<tokens.size(); i++)
+    {
+      delete tokens[i];
+    }
+}
+
+void LexedFile::append(ANTLRToken *token, ParseStore& store)
+{
+  store.take_line_counts(counts);
+  tokens.push_back(token);
+  counts_end.push_back(counts.size());
+}
+
+TokenReplay::TokenReplay(const LexedFile& file, size_t first, size_t last)
+  : lexedFile(file), firstToken(first), nextToken(first), lastToken(last)
+{
+}
+
+_ANTLRTokenPtr TokenReplay::getToken()
+{
+  // The parser deletes the tokens it has finished with, so it gets a
+  // copy of each.  Once we reach the end, we keep supplying copies of 
+  // the end of file token, as a lexer would.
+  // The counts reported before the first token of a fragment other
+  // than the first go to the previous fragment, with its end of file
+  // token, as that is the point at which a parse of the whole file 
+  // would have received them.
+  size_t i=nextToken;
+  if(nextToken<=lastToken)
+    {
+      if(i==0 || i>firstToken)
+	{
+	  size_t counts_begin= (i==0) ? 0 : lexedFile.counts_end[i-1];
+	  ParseStore::currentInstance()->add_line_counts(
+	    lexedFile.counts.begin()+counts_begin,
+	    lexedFile.counts.begin()+lexedFile.counts_end[i]);
+	}
+      nextToken++;
+    }
+  else
+    {
+      i=lastToken;
+    }
+
+  ANTLRToken *retval=new ANTLRToken(*lexedFile.tokens[i]);
+  if(i==lastToken)
+    {
+      retval->setType(lexedFile.tokens.back()->getType());
+    }
+  return retval;
+}
+
+TokenQueue::TokenQueue(size_t capacity)
+  : slots(capacity), head(0), tail(0), closed(false), lastToken(NULL)
+{
+}
+
+TokenQueue::~TokenQueue()
+{
+  // By now the lexer has finished, so any tokens the parser did not
+  // take are ours to delete.
+  for(size_t i=head.load(); i!=tail.load(); i++)
+    {
+      delete slots[i%slots.size()].token;
+    }
+  delete lastToken;
+}
+
+bool TokenQueue::put(ANTLRToken *token, ParseStore& store, bool is_last)
+{
+  size_t this_slot=tail.load(std::memory_order_relaxed);
+  while(this_slot-head.load(std::memory_order_acquire)==slots.size())
+    {
+      if(closed.load(std::memory_order_acquire))
+	{
+	  delete token;
+	  return false;
+	}
+      std::this_thread::yield();
+    }
+
+  Slot& slot=slots[this_slot%slots.size()];
+  slot.token=token;
+  slot.counts.clear();
+  store.take_line_counts(slot.counts);
+  slot.is_last=is_last;
+  tail.store(this_slot+1,std::memory_order_release);
+  return true;
+}
+
+_ANTLRTokenPtr TokenQueue::getToken()
+{
+  // Once we reach the end, we keep supplying copies of the end of file
+  // token, as a lexer would.
+  if(lastToken!=NULL)
+    {
+      return new ANTLRToken(*lastToken);
+    }
+
+  size_t this_slot=head.load(std::memory_order_relaxed);
+  while(tail.load(std::memory_order_acquire)==this_slot)
+    {
+      std::this_thread::yield();
+    }
+
+  Slot& slot=slots[this_slot%slots.size()];
+  ParseStore::currentInstance()->add_line_counts(slot.counts.begin(),
+						 slot.counts.end());
+  ANTLRToken *retval=slot.token;
+  if(slot.is_last)
+    {
+      lastToken=new ANTLRToken(*retval);
+    }
+  head.store(this_slot+1,std::memory_order_release);
+
+  // the token was counted on the lexer's thread, but the count which
+  // is reported is the parser's
+  ANTLRToken::RunningTokenCount++;
+  return retval;
 }
 
 static void toktrace(ANTLRAbstractToken *tok)
@@ -481,9 +741,9 @@ enum InOrOut { IO_IN, IO_OUT };
 static void rectrace(const char *rulename, 
 		     const char *dir_indic, 
 		     int guessing, 
-		     ANTLRAbstractToken *tok)
+		     ANTLRAbstractToken *tok,
+		     int& trace_depth)
 {
-  static int trace_depth=0;
   if(guessing)
     {
       DbgMsg(PARSER,cerr,
@@ -514,7 +774,7 @@ void ParseUtility::tracein(
   toktrace(tok);
   
   // then the indented recognition trace
-  rectrace(rulename,"-> ",guessing,tok);
+  rectrace(rulename,"-> ",guessing,tok,trace_depth);
 }
 
 void ParseUtility::traceout(const char *rulename, 
@@ -543,7 +803,7 @@ void ParseUtility::traceout(const char *rulename,
     }
   // first put out the token details
   toktrace(tok);
-  rectrace(rulename,"<- ",guessing,tok);
+  rectrace(rulename,"<- ",guessing,tok,trace_depth);
 }
   
 void ParseUtility::syn(
@@ -551,14 +811,15 @@ void ParseUtility::syn(
   ANTLRTokenType etok, int k) 
 {
   string filename=ParseStore::currentInstance()->filename();
+  ostream& err=error_stream();
   if(tok != NULL)
     {
-      cerr << filename << '(' << tok->getLine() << "):" 
+      err << filename << '(' << tok->getLine() << "):" 
 	   << " syntax error at token " << tok->getText() << endl;
     }
   else
     {
-      cerr << filename << "(0): syntax error at null token" << endl;
+      err << filename << "(0): syntax error at null token" << endl;
     }
 
 #if 1
@@ -567,20 +828,20 @@ void ParseUtility::syn(
 	  // It's only really useful to myself (TJL) or anyone
 	  // else with a taste for debugging cccc.g/java.g etc.
 	  int i=stack_depth-1;
-      cerr << filename << '(' << stack_tokenline[i] 
+      err << filename << '(' << stack_tokenline[i] 
 	   << "): trying to match " << stack_rules[i]
 	   << " at '" << stack_tokentext[i] << "'"
 	   << endl;
 #else
-  cerr << "Parser context:" << endl;
+  err << "Parser context:" << endl;
   for(int i=stack_depth-1; i>=0; i--)
     {
-      cerr << filename << '(' << stack_tokenline[i] 
+      err << filename << '(' << stack_tokenline[i] 
 	   << "): trying to match " << stack_rules[i]
 	   << " at '" << stack_tokentext[i] << "'"
 	   << endl;
     }	
-  cerr << endl;
+  err << endl;
 #endif
 }	
 
@@ -24,12 +24,15 @@
 #include "cccc.h"
 #include <map>
 #include <vector>
+#include <atomic>
+#include <time.h>
 #include "cccc_tok.h"
+#include "cccc_itm.h"
 #include "AParser.h"
 
 class ANTLRAbstractToken;
 class ANTLRTokenPtr;
-class CCCC_Item;
+class CCCC_Project;
 
 // this file declares all enumeration datatypes used in the project, and
 // also the parse state class, which is used to capture information in the
@@ -62,6 +65,14 @@ enum AugmentedBool {
 ostream& operator << (ostream& os, AugmentedBool ab);
 istream& operator >> (istream& is, AugmentedBool& ab);
 
+// ctime() formats into a static buffer, so the report writers, which 
+// may run on different threads at once, use this instead
+string TimeString(time_t t);
+
+// returns a 64 bit FNV-1a hash of some text, as 16 hex digits, which is 
+// used to tell whether a file has changed since it was last analyzed
+string ContentHash(const string& text);
+
 enum UseType { 
   utDECLARATION='D', utDEFINITION='d',  // of methods and classes
   utINHERITS='I',                       // inheritance, including Java 
@@ -164,19 +175,29 @@ class ParseUtility {
   // and a relative name.
   string scopeCombine(const string& baseScope, const string& name);
 
-  // Only one instance of this class should exist at any time.
+  // Syntax errors are reported on the stream returned by this method,
+  // which is cerr unless a caller wants to examine or discard them.
+  // Each call counts as one error.
+  ostream& error_stream() { error_count++; return *error_os; }
+  void set_error_stream(ostream& os) { error_os=&os; }
+  int errors() const { return error_count; }
+
+  // Only one instance of this class should exist at any time on each
+  // thread which is running a parser.
   // This method allows the parsers and lexers to access the instance.
   static ParseUtility *currentInstance() { return theCurrentInstance; }
 
  private:
-  static ParseUtility *theCurrentInstance;
+  static thread_local ParseUtility *theCurrentInstance;
 
   ANTLR_Assisted_Parser *parser;
+  ostream *error_os;
+  int error_count;
   int trace_depth;
-  static int stack_depth;
-  static string   stack_tokentext[MAX_STACK_DEPTH];
-  static int           stack_tokenline[MAX_STACK_DEPTH];  
-  static string   stack_rules[MAX_STACK_DEPTH];
+  int stack_depth;
+  string   stack_tokentext[MAX_STACK_DEPTH];
+  int           stack_tokenline[MAX_STACK_DEPTH];  
+  string   stack_rules[MAX_STACK_DEPTH];
 
   // copy constructor and assignment operator are private to
   // prevent unexpected copying
@@ -194,6 +215,19 @@ class ParseUtility {
   // used to apportion counts as the parser reports extents.
   enum LexicalCount { tcCOMLINES, tcCODELINES, tcMCCABES_VG, tcLAST };
 
+// Records created by the parser are normally passed straight on to the
+// project database.  When a file is parsed in fragments on different 
+// threads, each fragment's ParseStore holds its records in a list 
+// instead, and the lists are committed in order once the fragments 
+// have been stitched together.
+enum ParseRecordType { prtMODULE, prtMEMBER, prtUSEREL, prtREJEXT };
+typedef std::pair<ParseRecordType,CCCC_Item> ParseRecord;
+typedef std::vector<ParseRecord> ParseRecordList;
+
+// The counts for each line are held as an array indexed by LexicalCount.
+typedef std::vector<int> LexicalCountArray;
+typedef std::vector< std::pair<int,LexicalCountArray> > LineCountList;
+
 
 // The ParseStore class encapsulates all information storage 
 // requirements related to the parser, and also manages
@@ -209,7 +243,7 @@ class ParseUtility {
 class ParseStore
 {
  public:
-  ParseStore(const string& filename);
+  ParseStore(const string& filename, ParseRecordList *deferred_records=NULL);
   ~ParseStore();
 
   void IncrementCount(LexicalCount lc) { pendingLexicalCounts[lc]++; }
@@ -242,6 +276,32 @@ class ParseStore
 			      const string& description);
   void record_file_balance_extent(string);
 
+  // The parser calls this at the end of the file, to record the lines
+  // which have not been allocated to any other extent.
+  void record_file_scope_extent(int endLine);
+
+  // A file may be parsed in several fragments on different threads.
+  // The store for each fragment does not record a file scope extent,
+  // but leaves its unallocated line counts to be gathered up by the 
+  // store for the whole file, which also takes its records and, from 
+  // the last fragment, its flags.
+  void set_fragment(bool is_fragment) { isFragment=is_fragment; }
+  void take_line_counts(LineCountList& counts);
+  void add_line_counts(LineCountList::const_iterator first,
+		       LineCountList::const_iterator last);
+  void commit_records(ParseRecordList& records);
+
+  // this passes records which have been held back to the project
+  static void add_records_to_project(ParseRecordList& records);
+
+  // The extent in each record starts with the name of the source file,
+  // after the number of other fields given by filename_field, so that
+  // records held back may be passed on as if from another file.
+  static size_t filename_field(ParseRecordType rt);
+  static void rename_records(ParseRecordList& records, 
+			     const string& filename);
+  void restore_flags(const string& saved_flags);
+
   // Each of the record_XXX methods above uses this function to 
   // add an extent record.
   void insert_extent(CCCC_Item&, int, int, 
@@ -264,15 +324,21 @@ class ParseStore
   // and assignment operator to allow us to save state in the 
   // parser.
 
-  // Only one instance of this class should exist at any time.
+  // Only one instance of this class should exist at any time on each
+  // thread which is running a parser.
   // This method allows the parsers and lexers to access the instance.
   static ParseStore *currentInstance() { return theCurrentInstance; }
  private:
-  static ParseStore *theCurrentInstance;
+  static thread_local ParseStore *theCurrentInstance;
+
+  // Each of the record_XXX methods above passes its completed record
+  // through this function.
+  void commit_record(ParseRecordType rt, CCCC_Item& record);
 
   string theFilename;
+  ParseRecordList *deferredRecords;
+  bool isFragment;
 
-  typedef std::vector<int> LexicalCountArray;
   LexicalCountArray pendingLexicalCounts;
  
   typedef std::map<int,LexicalCountArray> LineLexicalCountMatrix;
@@ -287,6 +353,90 @@ class ParseStore
   const ParseStore& operator=(const ParseStore&);
 };
 
+// When a file is to be parsed in several fragments, it is lexed first
+// into a LexedFile, which holds all of its tokens together with the 
+// line counts which the lexer reported before each of them.
+class LexedFile
+{
+ public:
+  LexedFile() {}
+  ~LexedFile();
+
+  // This adds a token, taking from the store the line counts which 
+  // the lexer has reported since the previous token.
+  void append(ANTLRToken *token, ParseStore& store);
+
+  size_t size() const { return tokens.size(); }
+  ANTLRToken *token(size_t i) const { return tokens[i]; }
+
+ private:
+  friend class TokenReplay;
+  std::vector<ANTLRToken*> tokens;
+  LineCountList counts;
+  // the counts reported before token i end at counts[counts_end[i]]
+  std::vector<size_t> counts_end;
+
+  LexedFile(const LexedFile&);
+  const LexedFile& operator=(const LexedFile&);
+};
+
+// TokenReplay feeds tokens first to last-1 of a LexedFile to a parser,
+// followed by an end of file token on the line of token last.  
+// The line counts are passed to the current ParseStore at the same 
+// points in the token stream as the lexer reported them, so each 
+// extent in the fragment gets exactly the counts it would get in a 
+// parse of the whole file.
+class TokenReplay : public ANTLRTokenStream
+{
+ public:
+  TokenReplay(const LexedFile& file, size_t first, size_t last);
+  _ANTLRTokenPtr getToken();
+
+ private:
+  const LexedFile& lexedFile;
+  size_t firstToken, nextToken, lastToken;
+};
+
+// TokenQueue carries tokens from a lexer running ahead on one thread
+// to a parser on another, together with the line counts the lexer 
+// reported before each token, which are passed to the parser's 
+// ParseStore as the token is taken, as they are in TokenReplay.
+// The queue is a bounded ring with a single producer and a single 
+// consumer, so it needs no lock: each side only ever advances its own
+// index, and waits for the other by yielding.
+class TokenQueue : public ANTLRTokenStream
+{
+ public:
+  TokenQueue(size_t capacity=1024);
+  ~TokenQueue();
+
+  // This is called on the lexer's thread.  It takes from the store the
+  // line counts the lexer has reported since the previous token.
+  // It returns false, having deleted the token, if the parser has 
+  // closed the queue.
+  bool put(ANTLRToken *token, ParseStore& store, bool is_last);
+
+  // These are called on the parser's thread.
+  _ANTLRTokenPtr getToken();
+  void close() { closed.store(true); }
+
+ private:
+  struct Slot
+  {
+    ANTLRToken *token;
+    LineCountList counts;
+    bool is_last;
+  };
+  std::vector<Slot> slots;
+  std::atomic<size_t> head;	// the next slot to be read
+  std::atomic<size_t> tail;	// the next slot to be written
+  std::atomic<bool> closed;
+  ANTLRToken *lastToken;
+
+  TokenQueue(const TokenQueue&);
+  const TokenQueue& operator=(const TokenQueue&);
+};
+
 #endif
 
 
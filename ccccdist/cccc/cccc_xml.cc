@@ -41,12 +41,13 @@
 #include <string.h>
 #include <time.h>
 #include <sys/stat.h>
+#include <vector>
+#include <thread>
+#include <mutex>
 #include "cccc_utl.h"
 
 
 // class static data members
-CCCC_Project* CCCC_Xml_Stream::prjptr;
-string CCCC_Xml_Stream::outdir;
 string CCCC_Xml_Stream::libdir;
 
 static const string XML_PREAMBLE = "<?xml version=\"1.0\" encoding=\"utf-8\"?>";
@@ -147,12 +148,12 @@ static string ltrim(string value)
 void CCCC_Xml_Stream::GenerateReports(CCCC_Project* prj,
 				       int report_mask,
 				       const string& file,
-				       const string& dir)
+				       const string& dir,
+				       int threads,
+				       CCCC_PageManifest *manifest)
 {
-  prjptr=prj;
-  outdir=dir;
-
-  CCCC_Xml_Stream main_xml_stream(file.c_str(),"Report on software metrics");
+  CCCC_Xml_Stream main_xml_stream(file.c_str(),"Report on software metrics",
+				   prj,dir);
 
   // For testing purposes, we want to be able to disable the inclusion
   // of the current time in the report.  This enables us to store a
@@ -195,7 +196,7 @@ void CCCC_Xml_Stream::GenerateReports(CCCC_Project* prj,
 
   if(report_mask & rtSEPARATE_MODULES)
     {
-      main_xml_stream.Separate_Modules();
+      main_xml_stream.Separate_Modules(threads,manifest);
     }
 
   if(report_mask & rtOTHER)
@@ -204,10 +205,23 @@ void CCCC_Xml_Stream::GenerateReports(CCCC_Project* prj,
     }
 }
 
-CCCC_Xml_Stream::CCCC_Xml_Stream(const string& fname, const string& info)
+CCCC_Xml_Stream::CCCC_Xml_Stream(const string& fname, const string& info,
+				 CCCC_Project* project, const string& dir,
+				 CCCC_PageManifest *manifest)
+: page_filename(fname)
+, page_manifest(manifest)
+, outdir(dir)
+, prjptr(project)
 {
   // cerr << "Attempting to open file in directory " << outdir.c_str() << endl;
-  fstr.open(fname.c_str());
+  if(page_manifest!=NULL)
+    {
+      fstr.basic_ios<char>::rdbuf(&page_buffer);
+    }
+  else
+    {
+      fstr.open(fname.c_str());
+    }
   if(fstr.good() != TRUE)
     {
       cerr << "failed to open " << fname.c_str()
@@ -223,47 +237,55 @@ CCCC_Xml_Stream::CCCC_Xml_Stream(const string& fname, const string& info)
 CCCC_Xml_Stream::~CCCC_Xml_Stream()
 {
   fstr << XML_TAG_CLOSE_BEGIN << PROJECT_NODE_NAME << XML_TAG_CLOSE_END << endl;
-  fstr.close();
+  if(page_manifest!=NULL)
+    {
+      page_manifest->Write(page_filename,page_buffer.str());
+      fstr.basic_ios<char>::rdbuf(fstr.rdbuf());
+    }
+  else
+    {
+      fstr.close();
+    }
 }
 
 void CCCC_Xml_Stream::Timestamp()
 {
       time_t generationTime=time(NULL);
       fstr << XML_TAG_OPEN_BEGIN << TIMESTAMP_NODE_NAME << XML_TAG_OPEN_END
-           << ctime(&generationTime)
+           << TimeString(generationTime)
            << XML_TAG_CLOSE_BEGIN << TIMESTAMP_NODE_NAME << XML_TAG_CLOSE_END
            << endl;
 }
 
 void  CCCC_Xml_Stream::Project_Summary() {
   // calculate the counts on which all displayed data will be based
-  int nom=prjptr->get_count(COUNT_TAG_NUMBER_OF_MODULES);
-  int loc=prjptr->get_count(COUNT_TAG_LINES_OF_CODE);
-  int mvg=prjptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-  int com=prjptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
-  int if4=prjptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4);
-  int if4v=prjptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX);
-  int if4c=prjptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX);
-  int rej=prjptr->rejected_extent_table.get_count(COUNT_TAG_LINES_OF_CODE);
+  int nom=prjptr->get_count(miNOM);
+  int loc=prjptr->get_count(miLOC);
+  int mvg=prjptr->get_count(miMVG);
+  int com=prjptr->get_count(miCOM);
+  int if4=prjptr->get_count(miIF4);
+  int if4v=prjptr->get_count(miIF4v);
+  int if4c=prjptr->get_count(miIF4c);
+  int rej=prjptr->rejected_extent_table.get_count(miLOC);
 
   fstr << XML_TAG_OPEN_BEGIN << SUMMARY_NODE_NAME << XML_TAG_OPEN_END << endl;
 
   Put_Metric_Node(NOM_NODE_NAME,nom);
-  Put_Metric_Node(LOC_NODE_NAME,loc,"LOCp");
-  Put_Metric_Node(LOCPERMOD_NODE_NAME,loc,nom,"LOCper");
-  Put_Metric_Node(MVG_NODE_NAME,mvg,"MVGp");
-  Put_Metric_Node(MVGPERMOD_NODE_NAME,mvg,nom,"MVGper");
-  Put_Metric_Node(COM_NODE_NAME,com,"COM");
-  Put_Metric_Node(COMPERMOD_NODE_NAME,com,nom,"COMper");
-  Put_Metric_Node(LOCPERCOM_NODE_NAME,loc,com,"L_C");
-  Put_Metric_Node(MVGPERCOM_NODE_NAME,mvg,com,"M_C");
+  Put_Metric_Node(LOC_NODE_NAME,loc,tmLOCp);
+  Put_Metric_Node(LOCPERMOD_NODE_NAME,loc,nom,tmLOCper);
+  Put_Metric_Node(MVG_NODE_NAME,mvg,tmMVGp);
+  Put_Metric_Node(MVGPERMOD_NODE_NAME,mvg,nom,tmMVGper);
+  Put_Metric_Node(COM_NODE_NAME,com,tmCOM);
+  Put_Metric_Node(COMPERMOD_NODE_NAME,com,nom,tmCOMper);
+  Put_Metric_Node(LOCPERCOM_NODE_NAME,loc,com,tmL_C);
+  Put_Metric_Node(MVGPERCOM_NODE_NAME,mvg,com,tmM_C);
   Put_Metric_Node(IF4_NODE_NAME,if4);
-  Put_Metric_Node(IF4PERMOD_NODE_NAME,if4,nom,"8.3");
+  Put_Metric_Node(IF4PERMOD_NODE_NAME,if4,nom,tm8_3);
   Put_Metric_Node(IF4VIS_NODE_NAME,if4v);
-  Put_Metric_Node(IF4VISPERMOD_NODE_NAME,if4v,nom,"8.3");
+  Put_Metric_Node(IF4VISPERMOD_NODE_NAME,if4v,nom,tm8_3);
   Put_Metric_Node(IF4CON_NODE_NAME,if4c);
-  Put_Metric_Node(IF4CONPERMOD_NODE_NAME,if4c,nom,"8.3");
-  Put_Metric_Node(REJ_LOC_NODE_NAME,rej,"REJ");
+  Put_Metric_Node(IF4CONPERMOD_NODE_NAME,if4c,nom,tm8_3);
+  Put_Metric_Node(REJ_LOC_NODE_NAME,rej,tmREJ);
   fstr << XML_TAG_CLOSE_BEGIN << SUMMARY_NODE_NAME << XML_TAG_CLOSE_END << endl;
 }
 
@@ -271,21 +293,22 @@ void CCCC_Xml_Stream::OO_Design()
 {
   fstr << XML_TAG_OPEN_BEGIN << OODESIGN_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
   int i=0;
-  while(mod_ptr!=NULL)
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       i++;
       if( mod_ptr->is_trivial() == FALSE)
 	{
 	  fstr << XML_TAG_OPEN_BEGIN << MODULE_NODE_NAME << XML_TAG_OPEN_END << endl;
 	  Put_Label_Node(NAME_NODE_NAME,mod_ptr->name(nlSIMPLE).c_str(),0,"","");
 
-	  CCCC_Metric wmc1(mod_ptr->get_count("WMC1"),"WMC1");
-	  CCCC_Metric wmcv(mod_ptr->get_count("WMCv"),"WMCv");
-	  CCCC_Metric dit(mod_ptr->get_count("DIT"),"DIT");
-	  CCCC_Metric noc(mod_ptr->get_count("NOC"),"NOC");
-	  CCCC_Metric cbo(mod_ptr->get_count("CBO"),"CBO");
+	  CCCC_Metric wmc1(mod_ptr->get_count(miWMC1),tmWMC1);
+	  CCCC_Metric wmcv(mod_ptr->get_count(miWMCv),tmWMCv);
+	  CCCC_Metric dit(mod_ptr->get_count(miDIT),tmDIT);
+	  CCCC_Metric noc(mod_ptr->get_count(miNOC),tmNOC);
+	  CCCC_Metric cbo(mod_ptr->get_count(miCBO),tmCBO);
 
 	  Put_Metric_Node(WMC1_NODE_NAME,wmc1);
 	  Put_Metric_Node(WMCV_NODE_NAME,wmcv);
@@ -296,7 +319,7 @@ void CCCC_Xml_Stream::OO_Design()
 	  fstr << XML_TAG_CLOSE_BEGIN << MODULE_NODE_NAME << XML_TAG_CLOSE_END << endl;
 
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
   fstr << XML_TAG_CLOSE_BEGIN << OODESIGN_NODE_NAME << XML_TAG_CLOSE_END << endl;
 }
@@ -306,23 +329,24 @@ void CCCC_Xml_Stream::Procedural_Summary()
 
   fstr << XML_TAG_OPEN_BEGIN << PROCSUM_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
   int i=0;
-  while(mod_ptr!=NULL)
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       i++;
       if( mod_ptr->is_trivial() == FALSE)
 	{
 	  fstr << XML_TAG_OPEN_BEGIN << MODULE_NODE_NAME << XML_TAG_OPEN_END << endl;
 	  Put_Label_Node(NAME_NODE_NAME,mod_ptr->name(nlSIMPLE).c_str(),0,"","");
 
-	  int loc=mod_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-	  int mvg=mod_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-	  int com=mod_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
-	  CCCC_Metric mloc(loc,"LOCm");
-	  CCCC_Metric mmvg(mvg,"MVGm");
-	  CCCC_Metric ml_c(loc,com,"L_C");
-	  CCCC_Metric mm_c(mvg,com,"M_C");
+	  int loc=mod_ptr->get_count(miLOC);
+	  int mvg=mod_ptr->get_count(miMVG);
+	  int com=mod_ptr->get_count(miCOM);
+	  CCCC_Metric mloc(loc,tmLOCm);
+	  CCCC_Metric mmvg(mvg,tmMVGm);
+	  CCCC_Metric ml_c(loc,com,tmL_C);
+	  CCCC_Metric mm_c(mvg,com,tmM_C);
 
 	  Put_Metric_Node(LOC_NODE_NAME,mloc);
 	  Put_Metric_Node(MVG_NODE_NAME,mmvg);
@@ -331,7 +355,7 @@ void CCCC_Xml_Stream::Procedural_Summary()
 	  Put_Metric_Node(MVGPERCOM_NODE_NAME,mm_c);
 	  fstr << XML_TAG_CLOSE_BEGIN << MODULE_NODE_NAME << XML_TAG_CLOSE_END << endl;
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
 
     fstr << XML_TAG_CLOSE_BEGIN << PROCSUM_NODE_NAME << XML_TAG_CLOSE_END << endl;
@@ -341,41 +365,42 @@ void CCCC_Xml_Stream::Structural_Summary()
 {
   fstr << XML_TAG_OPEN_BEGIN << STRUCTSUM_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-  CCCC_Module* module_ptr=prjptr->module_table.first_item();
-  while(module_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* module_ptr=(*modIter).second;
       if(module_ptr->is_trivial()==FALSE)
 	{
 	  fstr << XML_TAG_OPEN_BEGIN << MODULE_NODE_NAME << XML_TAG_OPEN_END << endl;
 	  Put_Label_Node(NAME_NODE_NAME,module_ptr->name(nlSIMPLE).c_str(),0,"","");
 
-	  int fov=module_ptr->get_count("FOv");
-	  int foc=module_ptr->get_count("FOc");
-	  int fo=module_ptr->get_count("FO");
+	  int fov=module_ptr->get_count(miFOv);
+	  int foc=module_ptr->get_count(miFOc);
+	  int fo=module_ptr->get_count(miFO);
 
-	  int fiv=module_ptr->get_count("FIv");
-	  int fic=module_ptr->get_count("FIc");
-	  int fi=module_ptr->get_count("FI");
+	  int fiv=module_ptr->get_count(miFIv);
+	  int fic=module_ptr->get_count(miFIc);
+	  int fi=module_ptr->get_count(miFI);
 
-	  int if4v=module_ptr->get_count("IF4v");
-	  int if4c=module_ptr->get_count("IF4c");
-	  int if4=module_ptr->get_count("IF4");
+	  int if4v=module_ptr->get_count(miIF4v);
+	  int if4c=module_ptr->get_count(miIF4c);
+	  int if4=module_ptr->get_count(miIF4);
 
 	  // the last two arguments here turn on links to enable jumping between
 	  // the summary and detail cells for the same module
-	  Put_Metric_Node(FOV_NODE_NAME,CCCC_Metric(fov,"FOv"));
-	  Put_Metric_Node(FOC_NODE_NAME,CCCC_Metric(foc,"FOc"));
-	  Put_Metric_Node(FO_NODE_NAME,CCCC_Metric(fo,"FO"));
-	  Put_Metric_Node(FIV_NODE_NAME,CCCC_Metric(fiv,"FIv"));
-	  Put_Metric_Node(FIC_NODE_NAME,CCCC_Metric(fic,"FIc"));
-	  Put_Metric_Node(FI_NODE_NAME,CCCC_Metric(fi,"FI"));
-	  Put_Metric_Node(IF4VIS_NODE_NAME,CCCC_Metric(if4v,"IF4v"));
-	  Put_Metric_Node(IF4CON_NODE_NAME,CCCC_Metric(if4c,"IF4c"));
-	  Put_Metric_Node(IF4_NODE_NAME,CCCC_Metric(if4,"IF4"));
+	  Put_Metric_Node(FOV_NODE_NAME,CCCC_Metric(fov,tmFOv));
+	  Put_Metric_Node(FOC_NODE_NAME,CCCC_Metric(foc,tmFOc));
+	  Put_Metric_Node(FO_NODE_NAME,CCCC_Metric(fo,tmFO));
+	  Put_Metric_Node(FIV_NODE_NAME,CCCC_Metric(fiv,tmFIv));
+	  Put_Metric_Node(FIC_NODE_NAME,CCCC_Metric(fic,tmFIc));
+	  Put_Metric_Node(FI_NODE_NAME,CCCC_Metric(fi,tmFI));
+	  Put_Metric_Node(IF4VIS_NODE_NAME,CCCC_Metric(if4v,tmIF4v));
+	  Put_Metric_Node(IF4CON_NODE_NAME,CCCC_Metric(if4c,tmIF4c));
+	  Put_Metric_Node(IF4_NODE_NAME,CCCC_Metric(if4,tmIF4));
 
 	  fstr << XML_TAG_CLOSE_BEGIN << MODULE_NODE_NAME << XML_TAG_CLOSE_END << endl;
 	}
-      module_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
     fstr << XML_TAG_CLOSE_BEGIN << STRUCTSUM_NODE_NAME << XML_TAG_CLOSE_END << endl;
 }
@@ -448,14 +473,15 @@ void CCCC_Xml_Stream::Put_Structural_Details_Node(
 void CCCC_Xml_Stream::Structural_Detail()
 {
   fstr << XML_TAG_OPEN_BEGIN << STRUCTDET_NODE_NAME << XML_TAG_OPEN_END << endl;
-  CCCC_Module* module_ptr=prjptr->module_table.first_item();
-  while(module_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* module_ptr=(*modIter).second;
       if(module_ptr->is_trivial()==FALSE)
 	{
 	  Structural_Detail(module_ptr);
 	}
-      module_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
   fstr << XML_TAG_CLOSE_BEGIN << STRUCTDET_NODE_NAME << XML_TAG_CLOSE_END << endl;
 }
@@ -464,9 +490,10 @@ void CCCC_Xml_Stream::Procedural_Detail() {
 
   fstr << XML_TAG_OPEN_BEGIN << PROCDET_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
-  while(mod_ptr!=NULL)
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       if(
 	 (mod_ptr->name(nlMODULE_TYPE)!="builtin") &&
 	 (mod_ptr->name(nlMODULE_TYPE)!="enum") &&
@@ -479,7 +506,7 @@ void CCCC_Xml_Stream::Procedural_Detail() {
 	  Procedural_Detail(mod_ptr);
           fstr << XML_TAG_CLOSE_BEGIN << MODULE_NODE_NAME << XML_TAG_CLOSE_END << endl;
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
   fstr << XML_TAG_CLOSE_BEGIN << PROCDET_NODE_NAME << XML_TAG_CLOSE_END << endl;
 }
@@ -488,16 +515,17 @@ void CCCC_Xml_Stream::Other_Extents()
 {
    fstr << XML_TAG_OPEN_BEGIN << OTHER_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-   CCCC_Extent *extent_ptr=prjptr->rejected_extent_table.first_item();
-   while(extent_ptr!=NULL)
+   CCCC_Record::Extent_Table::iterator extIter=prjptr->rejected_extent_table.begin();
+   while(extIter!=prjptr->rejected_extent_table.end())
    {
+      CCCC_Extent *extent_ptr=&*extIter;
       fstr << XML_TAG_OPEN_BEGIN << REJECTED_NODE_NAME << XML_TAG_OPEN_END << endl;
       Put_Label_Node(NAME_NODE_NAME,extent_ptr->name(nlDESCRIPTION).c_str());
       Put_Extent_Node(*extent_ptr,0);
-      Put_Metric_Node(LOC_NODE_NAME,extent_ptr->get_count(COUNT_TAG_LINES_OF_CODE),"");
-      Put_Metric_Node(COM_NODE_NAME,extent_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT),"");
-      Put_Metric_Node(MVG_NODE_NAME,extent_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER),"");
-      extent_ptr=prjptr->rejected_extent_table.next_item();
+      Put_Metric_Node(LOC_NODE_NAME,extent_ptr->get_count(miLOC),tmNONE);
+      Put_Metric_Node(COM_NODE_NAME,extent_ptr->get_count(miCOM),tmNONE);
+      Put_Metric_Node(MVG_NODE_NAME,extent_ptr->get_count(miMVG),tmNONE);
+      extIter++;
       fstr << XML_TAG_CLOSE_BEGIN << REJECTED_NODE_NAME << XML_TAG_CLOSE_END << endl;
    }
 
@@ -528,16 +556,16 @@ void CCCC_Xml_Stream::Put_Label_Node(string nodeTag, string label, int width,
 
 
 void CCCC_Xml_Stream::Put_Metric_Node(string nodeTag,
-				       int count, string tag)
+				       int count, TreatmentId treatment_id)
 {
-  CCCC_Metric m(count, tag.c_str());
+  CCCC_Metric m(count, treatment_id);
   Put_Metric_Node(nodeTag,m);
 }
 
 void CCCC_Xml_Stream::Put_Metric_Node(string nodeTag,
-				       int num, int denom, string tag)
+				       int num, int denom, TreatmentId treatment_id)
 {
-  CCCC_Metric m(num,denom, tag.c_str());
+  CCCC_Metric m(num,denom, treatment_id);
   Put_Metric_Node(nodeTag,m);
 }
 
@@ -591,9 +619,10 @@ void CCCC_Xml_Stream::Put_Extent_Node(const CCCC_Extent& extent, int width, bool
 
 void CCCC_Xml_Stream::Put_Extent_List(CCCC_Record& record, bool withDescription)
 {
-  CCCC_Extent *ext_ptr=record.extent_table.first_item();
-  while(ext_ptr!=NULL)
+  CCCC_Record::Extent_Table::iterator extIter=record.extent_table.begin();
+  while(extIter!=record.extent_table.end())
     {
+      CCCC_Extent *ext_ptr=&*extIter;
       fstr << XML_TAG_OPEN_BEGIN << EXTENT_NODE_NAME << XML_TAG_OPEN_END
            << endl;
       if(withDescription)
@@ -606,7 +635,7 @@ void CCCC_Xml_Stream::Put_Extent_List(CCCC_Record& record, bool withDescription)
       Put_Extent_URL(*ext_ptr);
       fstr << XML_TAG_CLOSE_BEGIN << EXTENT_NODE_NAME << XML_TAG_CLOSE_END
            << endl;
-      ext_ptr=record.extent_table.next_item();
+      extIter++;
     }
 }
 
@@ -640,59 +669,102 @@ CCCC_Xml_Stream& operator <<(CCCC_Xml_Stream& os, const CCCC_Metric& mtc)
   return os;
 }
 
-void CCCC_Xml_Stream::Separate_Modules()
+void CCCC_Xml_Stream::Separate_Modules(int threads, 
+					CCCC_PageManifest *manifest)
 {
-  // this function generates a separate HTML report for each non-trivial
+  // this function generates a separate XML report for each non-trivial
   // module in the database
-
-  CCCC_Module* mod_ptr=prjptr->module_table.first_item();
-  while(mod_ptr!=NULL)
+  // The reports are independent of one another, so they are shared out
+  // among a number of threads, each of which takes the next module on 
+  // the list until none are left.
+  std::vector<CCCC_Module*> modules;
+  CCCC_Table<CCCC_Module>::iterator modIter=prjptr->module_table.begin();
+  while(modIter!=prjptr->module_table.end())
     {
+      CCCC_Module* mod_ptr=(*modIter).second;
       int trivial_module=mod_ptr->is_trivial();
       if(trivial_module==FALSE)
 	{
-	  string info="Detailed report on module " + mod_ptr->key();
-	  string filename=outdir;
-	  filename+="/";
-	  filename+=mod_ptr->key()+".xml";
-	  CCCC_Xml_Stream module_xml_str(filename,info.c_str());
-
-	  module_xml_str.Module_Summary(mod_ptr);
-
-          module_xml_str.fstr
-             << XML_TAG_OPEN_BEGIN << MODDET_NODE_NAME << XML_TAG_OPEN_END
-             << endl;
-	  module_xml_str.Module_Detail(mod_ptr);
-          module_xml_str.fstr
-             << XML_TAG_CLOSE_BEGIN << MODDET_NODE_NAME << XML_TAG_CLOSE_END
-             << endl;
-
-          module_xml_str.fstr
-             << XML_TAG_OPEN_BEGIN << PROCDET_NODE_NAME << XML_TAG_OPEN_END
-             << endl;
-	  module_xml_str.Procedural_Detail(mod_ptr);
-          module_xml_str.fstr
-             << XML_TAG_CLOSE_BEGIN << PROCDET_NODE_NAME << XML_TAG_CLOSE_END
-             << endl;
-
-          module_xml_str.fstr
-             << XML_TAG_OPEN_BEGIN << STRUCTDET_NODE_NAME << XML_TAG_OPEN_END
-             << endl;
-	  module_xml_str.Structural_Detail(mod_ptr);
-          module_xml_str.fstr
-             << XML_TAG_CLOSE_BEGIN << STRUCTDET_NODE_NAME << XML_TAG_CLOSE_END
-             << endl;
-
+	  modules.push_back(mod_ptr);
 	}
       else
 	{
 #if 0
-	  cerr << mod_ptr->module_type << " " << mod_ptr->key()
+	  cerr << mod_ptr->name(nlMODULE_TYPE) << " " << mod_ptr->key()
 	       << " is trivial" << endl;
 #endif
 	}
-      mod_ptr=prjptr->module_table.next_item();
+      modIter++;
     }
+
+  std::mutex modules_mutex;
+  size_t next_module=0;
+  auto write_reports=[&]()
+    {
+      for(;;)
+	{
+	  CCCC_Module *mod_ptr;
+	  {
+	    std::lock_guard<std::mutex> lock(modules_mutex);
+	    if(next_module==modules.size())
+	      {
+		break;
+	      }
+	    mod_ptr=modules[next_module++];
+	  }
+	  Separate_Module(mod_ptr,manifest);
+	}
+    };
+
+  // this thread does its share too
+  std::vector<std::thread> writers;
+  for(int i=1; i<threads && static_cast<size_t>(i)<modules.size(); i++)
+    {
+      writers.push_back(std::thread(write_reports));
+    }
+  write_reports();
+  for(size_t i=0; i<writers.size(); i++)
+    {
+      writers[i].join();
+    }
+}
+
+void CCCC_Xml_Stream::Separate_Module(CCCC_Module *mod_ptr, 
+				       CCCC_PageManifest *manifest)
+{
+  // this function generates the separate XML report for one module
+  string info="Detailed report on module " + mod_ptr->key();
+  string filename=outdir;
+  filename+="/";
+  filename+=mod_ptr->key()+".xml";
+  CCCC_Xml_Stream module_xml_str(filename,info.c_str(),prjptr,outdir,
+				  manifest);
+
+  module_xml_str.Module_Summary(mod_ptr);
+
+  module_xml_str.fstr
+     << XML_TAG_OPEN_BEGIN << MODDET_NODE_NAME << XML_TAG_OPEN_END
+     << endl;
+  module_xml_str.Module_Detail(mod_ptr);
+  module_xml_str.fstr
+     << XML_TAG_CLOSE_BEGIN << MODDET_NODE_NAME << XML_TAG_CLOSE_END
+     << endl;
+
+  module_xml_str.fstr
+     << XML_TAG_OPEN_BEGIN << PROCDET_NODE_NAME << XML_TAG_OPEN_END
+     << endl;
+  module_xml_str.Procedural_Detail(mod_ptr);
+  module_xml_str.fstr
+     << XML_TAG_CLOSE_BEGIN << PROCDET_NODE_NAME << XML_TAG_CLOSE_END
+     << endl;
+
+  module_xml_str.fstr
+     << XML_TAG_OPEN_BEGIN << STRUCTDET_NODE_NAME << XML_TAG_OPEN_END
+     << endl;
+  module_xml_str.Structural_Detail(mod_ptr);
+  module_xml_str.fstr
+     << XML_TAG_CLOSE_BEGIN << STRUCTDET_NODE_NAME << XML_TAG_CLOSE_END
+     << endl;
 }
 
 void CCCC_Xml_Stream::Module_Detail(CCCC_Module *module_ptr)
@@ -711,15 +783,15 @@ void CCCC_Xml_Stream::Module_Detail(CCCC_Module *module_ptr)
   CCCC_Record::Extent_Table::iterator eIter = module_ptr->extent_table.begin();
   while(eIter!=module_ptr->extent_table.end())
   {
-     CCCC_Extent *ext_ptr=(*eIter).second;
+     CCCC_Extent *ext_ptr=&*eIter;
      Put_Extent_Node(*ext_ptr,0,true);
-     int loc=ext_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-     int mvg=ext_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-     int com=ext_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
-     CCCC_Metric mloc(loc,"LOCf");
-     CCCC_Metric mmvg(mvg,"MVGf");
-     CCCC_Metric ml_c(loc,com,"L_C");
-     CCCC_Metric mm_c(mvg,com,"M_C");
+     int loc=ext_ptr->get_count(miLOC);
+     int mvg=ext_ptr->get_count(miMVG);
+     int com=ext_ptr->get_count(miCOM);
+     CCCC_Metric mloc(loc,tmLOCf);
+     CCCC_Metric mmvg(mvg,tmMVGf);
+     CCCC_Metric ml_c(loc,com,tmL_C);
+     CCCC_Metric mm_c(mvg,com,tmM_C);
 
      Put_Metric_Node(LOC_NODE_NAME,mloc);
      Put_Metric_Node(MVG_NODE_NAME,mmvg);
@@ -744,21 +816,21 @@ void CCCC_Xml_Stream::Procedural_Detail(CCCC_Module *module_ptr)
   // 2. within the Procedural_Detail function, where the table tags are
   //    around the output of many calls to this function
 
-  CCCC_Module::member_map_t::iterator iter = module_ptr->member_map.begin();
+  CCCC_Module::member_list_t::iterator iter = module_ptr->member_list.begin();
 
-      while(iter!=module_ptr->member_map.end())
+      while(iter!=module_ptr->member_list.end())
 	{
           fstr << XML_TAG_OPEN_BEGIN << MEMBER_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-	  CCCC_Member *mem_ptr=(*iter).second;
+	  CCCC_Member *mem_ptr=*iter;
 	  Put_Label_Node(NAME_NODE_NAME,mem_ptr->name(nlLOCAL).c_str(),0,"","",mem_ptr);
-	  int loc=mem_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-	  int mvg=mem_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-	  int com=mem_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
-	  CCCC_Metric mloc(loc,"LOCf");
-	  CCCC_Metric mmvg(mvg,"MVGf");
-	  CCCC_Metric ml_c(loc,com,"L_C");
-	  CCCC_Metric mm_c(mvg,com,"M_C");
+	  int loc=mem_ptr->get_count(miLOC);
+	  int mvg=mem_ptr->get_count(miMVG);
+	  int com=mem_ptr->get_count(miCOM);
+	  CCCC_Metric mloc(loc,tmLOCf);
+	  CCCC_Metric mmvg(mvg,tmMVGf);
+	  CCCC_Metric ml_c(loc,com,tmL_C);
+	  CCCC_Metric mm_c(mvg,com,tmM_C);
 
           Put_Metric_Node(LOC_NODE_NAME,mloc);
           Put_Metric_Node(MVG_NODE_NAME,mmvg);
@@ -786,42 +858,42 @@ void CCCC_Xml_Stream::Module_Summary(CCCC_Module *module_ptr)
   // calculate the counts on which all displayed data will be based
   // int nof=module_ptr->member_table.records(); // Number of functions
   int nof=0;
-  int loc=module_ptr->get_count(COUNT_TAG_LINES_OF_CODE);
-  int mvg=module_ptr->get_count(COUNT_TAG_CYCLOMATIC_NUMBER);
-  int com=module_ptr->get_count(COUNT_TAG_LINES_OF_COMMENT);
+  int loc=module_ptr->get_count(miLOC);
+  int mvg=module_ptr->get_count(miMVG);
+  int com=module_ptr->get_count(miCOM);
 
   // the variants of IF4 measure information flow and couplings
-  int if4=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4);
-  int if4v=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_VISIBLE_SUFFIX);
-  int if4c=module_ptr->get_count(COUNT_TAG_INTERMODULE_COMPLEXITY4 COUNT_TAG_CONCRETE_SUFFIX);
+  int if4=module_ptr->get_count(miIF4);
+  int if4v=module_ptr->get_count(miIF4v);
+  int if4c=module_ptr->get_count(miIF4c);
 
-  int wmc1=module_ptr->get_count(COUNT_TAG_WEIGHTED_METHODS_PER_CLASS_UNITY);
-  int wmcv=module_ptr->get_count(COUNT_TAG_WEIGHTED_METHODS_PER_CLASS COUNT_TAG_VISIBLE_SUFFIX);
-  int dit=module_ptr->get_count(COUNT_TAG_INHERITANCE_TREE_DEPTH);
-  int noc=module_ptr->get_count(COUNT_TAG_NUMBER_OF_CHILDREN);
-  int cbo=module_ptr->get_count(COUNT_TAG_COUPLING_BETWEEN_OBJECTS);
+  int wmc1=module_ptr->get_count(miWMC1);
+  int wmcv=module_ptr->get_count(miWMCv);
+  int dit=module_ptr->get_count(miDIT);
+  int noc=module_ptr->get_count(miNOC);
+  int cbo=module_ptr->get_count(miCBO);
 
   fstr << XML_TAG_OPEN_BEGIN << MODSUM_NODE_NAME << XML_TAG_OPEN_END << endl;
 
-  Put_Metric_Node(LOC_NODE_NAME,loc,"LOCm");
-  Put_Metric_Node(LOCPERMEM_NODE_NAME,loc,nof,"LOCg");
-  Put_Metric_Node(MVG_NODE_NAME,mvg,"MVGm");
-  Put_Metric_Node(MVGPERMEM_NODE_NAME,mvg,nof,"MVGf");
-  Put_Metric_Node(LOC_NODE_NAME,com,"COMm");
-  Put_Metric_Node(LOCPERMEM_NODE_NAME,com,nof,"8.3");
-  Put_Metric_Node(LOCPERCOM_NODE_NAME,loc,com,"L_C");
-  Put_Metric_Node(MVGPERCOM_NODE_NAME,mvg,com,"M_C");
+  Put_Metric_Node(LOC_NODE_NAME,loc,tmLOCm);
+  Put_Metric_Node(LOCPERMEM_NODE_NAME,loc,nof,tmLOCg);
+  Put_Metric_Node(MVG_NODE_NAME,mvg,tmMVGm);
+  Put_Metric_Node(MVGPERMEM_NODE_NAME,mvg,nof,tmMVGf);
+  Put_Metric_Node(LOC_NODE_NAME,com,tmCOMm);
+  Put_Metric_Node(LOCPERMEM_NODE_NAME,com,nof,tm8_3);
+  Put_Metric_Node(LOCPERCOM_NODE_NAME,loc,com,tmL_C);
+  Put_Metric_Node(MVGPERCOM_NODE_NAME,mvg,com,tmM_C);
   Put_Metric_Node(WMC1_NODE_NAME,wmc1);
   Put_Metric_Node(WMCV_NODE_NAME,wmcv);
   Put_Metric_Node(DIT_NODE_NAME,dit);
   Put_Metric_Node(NOC_NODE_NAME,noc);
   Put_Metric_Node(CBO_NODE_NAME,cbo);
-  Put_Metric_Node(IF4_NODE_NAME,if4,1,"IF4");
-  Put_Metric_Node(IF4PERMEM_NODE_NAME,if4,nof,"8.3");
-  Put_Metric_Node(IF4VIS_NODE_NAME,if4v,1,"IF4v");
-  Put_Metric_Node(IF4VISPERMEM_NODE_NAME,if4v,nof,"8.3");
-  Put_Metric_Node(IF4CON_NODE_NAME,if4c,1,"IF4c");
-  Put_Metric_Node(IF4CONPERMEM_NODE_NAME,if4c,nof,"8.3");
+  Put_Metric_Node(IF4_NODE_NAME,if4,1,tmIF4);
+  Put_Metric_Node(IF4PERMEM_NODE_NAME,if4,nof,tm8_3);
+  Put_Metric_Node(IF4VIS_NODE_NAME,if4v,1,tmIF4v);
+  Put_Metric_Node(IF4VISPERMEM_NODE_NAME,if4v,nof,tm8_3);
+  Put_Metric_Node(IF4CON_NODE_NAME,if4c,1,tmIF4c);
+  Put_Metric_Node(IF4CONPERMEM_NODE_NAME,if4c,nof,tm8_3);
 
   fstr << XML_TAG_CLOSE_BEGIN << MODSUM_NODE_NAME << XML_TAG_CLOSE_END << endl;
 }
@@ -45,9 +45,12 @@ class CCCC_Xml_Stream {
 				       const CCCC_Metric& mtc);
 
   ofstream fstr;
+  std::stringbuf page_buffer;
+  string page_filename;
+  CCCC_PageManifest *page_manifest;
   static string libdir;
-  static string outdir;
-  static CCCC_Project* prjptr;
+  string outdir;
+  CCCC_Project* prjptr;
 
   void Timestamp();
   void Project_Summary();
@@ -57,7 +60,8 @@ class CCCC_Xml_Stream {
   void Structural_Detail();
   void OO_Design();
   void Other_Extents();
-  void Separate_Modules();
+  void Separate_Modules(int threads, CCCC_PageManifest *manifest);
+  void Separate_Module(CCCC_Module *module_ptr, CCCC_PageManifest *manifest);
   void Source_Listing();
 
 
@@ -72,8 +76,8 @@ class CCCC_Xml_Stream {
 		      string ref_name="", string ref_href="", 
 		      CCCC_Record *rec_ptr=0);
   void Put_Metric_Node(string nodeTag, const CCCC_Metric& metric);
-  void Put_Metric_Node(string nodeTag, int count, string tag);
-  void Put_Metric_Node(string nodeTag, int num, int denom, string tag);
+  void Put_Metric_Node(string nodeTag, int count, TreatmentId treatment_id);
+  void Put_Metric_Node(string nodeTag, int num, int denom, TreatmentId treatment_id);
   void Put_Extent_URL(const CCCC_Extent& extent);
   void Put_Extent_Node(const CCCC_Extent& extent, int width=0, bool withDescription=false);
   void Put_Extent_List(CCCC_Record& record,bool withDescription=false);
@@ -83,11 +87,19 @@ class CCCC_Xml_Stream {
 				   UserelNameLevel nl);
 
  public:
+  // the separate module reports are shared out among the given number 
+  // of threads
   static void GenerateReports(CCCC_Project* project, int report_mask, 
-			      const string& outfile, const string& outdir);
+			      const string& outfile, const string& outdir,
+			      int threads=1,
+			      CCCC_PageManifest *manifest=NULL);
 
   // general-purpose constructor with standard preamble
-  CCCC_Xml_Stream(const string& fname, const string& info);
+  // if a manifest is given, the page is gathered in memory and written 
+  // through the manifest by the destructor
+  CCCC_Xml_Stream(const string& fname, const string& info,
+		  CCCC_Project* project, const string& dir,
+		  CCCC_PageManifest *manifest=NULL);
     
   // destructor with standard trailer
   ~CCCC_Xml_Stream();
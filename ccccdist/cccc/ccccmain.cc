@@ -9,7 +9,19 @@
 
 #include <fstream>
 #include <list>
+#include <set>
 #include <iterator>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -17,7 +29,15 @@
 #define HANDLE intptr_t
 #define INVALID_HANDLE_VALUE -1
 #else
-#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
 #endif
 
 #include "cccc_itm.h"
@@ -25,6 +45,9 @@
 #include "cccc_met.h"
 #include "cccc_db.h"
 #include "cccc_utl.h"
+#include "cccc_src.h"
+#include "cccc_cch.h"
+#include "cccc_qry.h"
 #include "cccc_htm.h"
 #include "cccc_xml.h"
 
@@ -64,7 +87,11 @@ int _CRT_glob = 0;
 /*
 ** global variables to hold default values for various things
 */
-string current_filename, current_rule, parse_language;
+string current_filename, current_rule;
+
+// the language of the file being parsed is needed by the lexer, and 
+// each thread running a parser has its own
+thread_local string parse_language;
 
 // class Main encapsulates the top level of control for the program
 // including command line handling
@@ -87,6 +114,55 @@ class Main
   int report_mask; 
   int debug_mask;
   int files_parsed;
+  int jobs;
+  int workers;
+
+  // A run may be restricted to one shard of the file list, in which 
+  // case it saves a database fragment and generates no reports.
+  // Fragments from all of the shards are combined by a later run 
+  // in merge mode.
+  int shard_index;
+  int shard_count;
+  bool merge_mode;
+  int databases_merged;
+
+  // A report only run loads the databases named, or failing that the
+  // one saved by the previous run, and generates the reports from them
+  // under the current options, without reading any source file.
+  bool report_only;
+
+  // When the work is spread over several threads or processes, the cost
+  // of parsing each file is recorded in the database, and the costs 
+  // recorded by the previous run are used to start the most expensive
+  // files first.
+  bool record_costs;
+  CCCC_Project::FileCostTable cost_history;
+  double usec_per_byte;
+
+  // Source files are read into memory by a background thread, up to 
+  // this many files and megabytes ahead of the parsers.
+  int prefetch_files;
+  int prefetch_megabytes;
+
+  // C and C++ files of at least twice this many lines are split at 
+  // top level declarations into fragments of about this many lines, 
+  // which are parsed on up to --jobs threads.
+  int split_lines;
+
+  // The lexer may run ahead of the parser on a thread of its own.
+  bool pipeline;
+
+  // The records found in each file may be kept in a cache directory,
+  // from which they are taken for any file with the same content.
+  string cache_dir;
+  std::unique_ptr<CCCC_ResultCache> cache;
+
+  // The files may be read from a revision in a git repository, rather
+  // than from the working tree.  If none are named, all of the files 
+  // in the revision below the current directory in a known language 
+  // are analyzed.
+  string git_rev;
+  std::unique_ptr<CCCC_GitSource> git_source;
 
   // As we gather up the list of files to be processed
   // we work out and record the appropriate language to 
@@ -94,10 +170,139 @@ class Main
   typedef std::pair<string,string> file_entry;
   std::list<file_entry> file_list;
 
+  // An incremental run loads the database saved by the previous one,
+  // and parses only the files which have changed since.  The extents 
+  // from each file parsed are still keyed by its place in the full 
+  // list, which is recorded here, with one more entry for the block 
+  // following the list.
+  bool incremental;
+  int files_reused;
+  std::vector<unsigned int> key_blocks;
+  unsigned int KeyBlock(size_t index);
+  string FileHash(const file_entry& entry);
+
+  // A delta run loads a baseline database, and parses only the files
+  // which git reports as changed since the given revision, or which 
+  // the baseline does not cover.  If no files are named, the list is 
+  // made up of the files in the baseline, less those deleted since, 
+  // and those added since, in order of their paths.
+  string baseline_db;
+  string changed_from;
+
+  // With --dedup, a file with the same content and language as one 
+  // before it in the list is not parsed.  Either the records of the 
+  // first copy are passed on again for each other copy, under its own 
+  // name and key block, giving the same results as parsing every copy,
+  // or the other copies are left out, so that the content is counted 
+  // once.
+  string dedup_mode;
+  struct DuplicateFile
+  {
+    file_entry entry;
+    unsigned int key_block;
+    string original;
+  };
+  std::vector<DuplicateFile> duplicate_files;
+  std::set<string> retained_files;
+  std::map<string,ParseRecordList> retained_records;
+  std::mutex retained_mutex;
+  void SelectDistinctFiles();
+  void RetainRecords(const string& filename, const ParseRecordList& records);
+  void CopyDuplicateRecords();
+
+  // In watch mode the project is kept after the first run, and brought
+  // up to date each time any of the files in the full list changes.
+  bool watch;
+  std::vector<file_entry> watched_files;
+  void UpdateFiles(const std::set<size_t>& changed);
+
+  // A server keeps the project in the same way, and answers requests 
+  // made over a local socket, without writing any reports.  The files 
+  // it is asked to analyze are added to the full list if they are new.
+  string serve_socket;
+  bool Analyze(CCCC_Item& request, string& message);
+  bool HandleRequest(const string& request_line, std::ostream& reply);
+
+
 // this function encapsulates adding an argument to the file_list
 // for the time being, on Win32 only, it also performs filename globbing
   void AddFileArgument(const string&);
 
+// this function parses a single file, passing the records straight
+// to the database, and optionally measuring the cost of doing so
+// the text of the file may be supplied, if it has already been read
+  bool ParseFile(const file_entry& entry, 
+		 CCCC_Project::FileCost *cost=NULL,
+		 const string *source_text=NULL);
+
+#ifdef CC_INCLUDED
+// these functions parse a large C/C++ file in fragments
+  void ParseFileInFragments(const string& filename, const string& language,
+			    DLGInputStream& in, ParseStore& ps);
+  int ParseFragment(const LexedFile& lexed, size_t first, size_t last,
+		    const string& filename, const string& language,
+		    const string& initial_flags, ParseRecordList& records, 
+		    LineCountList& unallocated, string& final_flags, 
+		    ostream& err);
+#endif
+
+// this function runs a parser over a file, with its lexer either in 
+// step on the same thread or running ahead on a thread of its own
+  template <class Lexer, class Parser>
+  void RunParser(DLGInputStream& in, 
+		 const string& filename, const string& language, 
+		 void (Parser::*start_rule)());
+
+// this function starts reading the named files in the background,
+// if prefetching is enabled and worthwhile
+  CCCC_SourcePrefetcher *StartPrefetch(const std::vector<string>& filenames);
+
+// these functions support scheduling files according to their cost
+  void LoadCostHistory();
+  std::vector<double> EstimateCosts(const std::vector<file_entry>& entries);
+
+// when more than one job is allowed, files are parsed on a pool of
+// threads and their records are replayed in file list order
+  int ParseFilesConcurrently();
+
+// this function parses the files in file_list within the current process
+  int ParseFilesInProcess();
+
+// when more than one worker is requested, the file list is divided
+// into contiguous slices, each of which is parsed by a child process 
+// that saves its findings to a database fragment, and the fragments 
+// are merged back in order
+  struct WorkerProcess
+  {
+    int pid;
+    int result_fd;
+    size_t first, last;
+    string fragment;
+  };
+  int ParseFilesInWorkers();
+  WorkerProcess StartWorker(const std::vector<file_entry>& entries,
+			    size_t first, size_t last, 
+			    const string& fragment);
+  bool FinishWorker(const std::vector<file_entry>& entries,
+		    WorkerProcess& worker);
+
+  void MakeOutputDirectory();
+
+// this function selects the files belonging to the requested shard
+  void SelectShard();
+
+// this function brings the database from the previous run up to date 
+// and selects the files which need to be parsed again
+  void SelectChangedFiles();
+
+// this function loads the baseline database and selects the files which
+// have changed since it was saved, according to git
+  void SelectDeltaFiles();
+
+// in merge mode, the files named on the command line are database
+// fragments, which are loaded by this function
+  int MergeDatabases();
+
 public:
 
   Main();
@@ -107,12 +312,18 @@ public:
   void PrintCredits(ostream& os);
   void PrintUsage(ostream& os);
   int ParseFiles();
+  void SaveResults();
+  void Watch();
+  void Serve();
   int DumpDatabase();
   int LoadDatabase();
-  void GenerateHtml();
-  void GenerateXml();
+  bool MergeDatabase(const string& filename);
+  void GenerateReports();
+  void GenerateHtml(CCCC_PageManifest *manifest);
+  void GenerateXml(CCCC_PageManifest *manifest);
   void DescribeOutput();
   int filesParsed();
+  bool resultsAvailable();
 
   friend int main(int argc, char** argv);
 };
@@ -124,6 +335,22 @@ Main::Main()
   report_mask=0xFFFF&(~(rtPROC2|rtSTRUCT2)) ;  
   debug_mask=0;
   files_parsed=0;
+  jobs=1;
+  workers=1;
+  shard_index=0;
+  shard_count=0;
+  merge_mode=false;
+  databases_merged=0;
+  report_only=false;
+  record_costs=false;
+  usec_per_byte=1.0;
+  prefetch_files=4;
+  prefetch_megabytes=64;
+  split_lines=0;
+  pipeline=false;
+  incremental=false;
+  files_reused=0;
+  watch=false;
 }
 
 void Main::HandleArgs(int argc, char **argv)
@@ -157,6 +384,26 @@ void Main::HandleArgs(int argc, char **argv)
 	  PrintUsage(cout);
 	  exit(1);
 	}
+      else if(next_arg=="--merge")
+	{
+	  merge_mode=true;
+	}
+      else if(next_arg=="--pipeline")
+	{
+	  pipeline=true;
+	}
+      else if(next_arg=="--report_only")
+	{
+	  report_only=true;
+	}
+      else if(next_arg=="--incremental")
+	{
+	  incremental=true;
+	}
+      else if(next_arg=="--watch")
+	{
+	  watch=true;
+	}
       else
 	{
 	  // the options below this point are all of the form --opt=val,
@@ -177,6 +424,36 @@ void Main::HandleArgs(int argc, char **argv)
 		{
 		  outdir=next_val;
 		}
+	      else if(next_opt=="--serve")
+		{
+		  serve_socket=next_val;
+		}
+	      else if(next_opt=="--baseline_db")
+		{
+		  baseline_db=next_val;
+		}
+	      else if(next_opt=="--changed_from")
+		{
+		  changed_from=next_val;
+		}
+	      else if(next_opt=="--git_rev")
+		{
+		  git_rev=next_val;
+		}
+	      else if(next_opt=="--dedup")
+		{
+		  dedup_mode=next_val;
+		  if(dedup_mode!="path" && dedup_mode!="once")
+		    {
+		      cerr << "Invalid dedup mode " << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
+	      else if(next_opt=="--cache_dir")
+		{
+		  cache_dir=next_val;
+		}
 	      else if(next_opt=="--db_infile")
 		{
 		  db_infile=next_val;
@@ -206,6 +483,74 @@ void Main::HandleArgs(int argc, char **argv)
 		{
 		  lang=next_val;
 		}
+	      else if(next_opt=="--jobs")
+		{
+		  jobs=atoi(next_val.c_str());
+		  if(jobs<1)
+		    {
+		      cerr << "Invalid number of jobs " << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
+	      else if(next_opt=="--prefetch")
+		{
+		  prefetch_files=atoi(next_val.c_str());
+		  if(prefetch_files<0)
+		    {
+		      cerr << "Invalid number of files to prefetch " 
+			   << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
+	      else if(next_opt=="--prefetch_memory")
+		{
+		  prefetch_megabytes=atoi(next_val.c_str());
+		  if(prefetch_megabytes<1)
+		    {
+		      cerr << "Invalid prefetch memory limit " 
+			   << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
+	      else if(next_opt=="--split_lines")
+		{
+		  split_lines=atoi(next_val.c_str());
+		  if(split_lines<0)
+		    {
+		      cerr << "Invalid fragment size " << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
+	      else if(next_opt=="--shard")
+		{
+		  // the value is of the form <index>/<count>
+		  if(
+		     sscanf(next_val.c_str(),"%d/%d",
+			    &shard_index,&shard_count)!=2 ||
+		     shard_count<1 || 
+		     shard_index<0 || 
+		     shard_index>=shard_count
+		     )
+		    {
+		      cerr << "Invalid shard " << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
+	      else if(next_opt=="--workers")
+		{
+		  workers=atoi(next_val.c_str());
+		  if(workers<1)
+		    {
+		      cerr << "Invalid number of workers " << next_val << endl;
+		      PrintUsage(cerr);
+		      exit(2);
+		    }
+		}
 	      else if(next_opt=="--report_mask")
 		{
 		  // The report option may either be an integer flag vector
@@ -230,6 +575,84 @@ void Main::HandleArgs(int argc, char **argv)
 	}
     }
 
+  if(merge_mode && shard_count>0)
+    {
+      cerr << "--merge and --shard cannot be used together" << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(incremental && (merge_mode || shard_count>0 || workers>1))
+    {
+      cerr << "--incremental cannot be used with --merge, --shard or --workers"
+	   << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(watch && (merge_mode || shard_count>0))
+    {
+      cerr << "--watch cannot be used with --merge or --shard" << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if((baseline_db=="")!=(changed_from==""))
+    {
+      cerr << "--baseline_db and --changed_from must be used together" << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(baseline_db!="" && 
+     (merge_mode || shard_count>0 || workers>1 || incremental))
+    {
+      cerr << "--baseline_db cannot be used with --merge, --shard, --workers"
+	   << " or --incremental" << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(git_rev!="" && (merge_mode || workers>1 || watch))
+    {
+      cerr << "--git_rev cannot be used with --merge, --workers or --watch" 
+	   << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(serve_socket!="" && (merge_mode || shard_count>0 || watch))
+    {
+      cerr << "--serve cannot be used with --merge, --shard or --watch" 
+	   << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(report_only && 
+     (merge_mode || shard_count>0 || workers>1 || incremental || 
+      baseline_db!="" || git_rev!="" || watch || serve_socket!=""))
+    {
+      cerr << "--report_only cannot be used with --merge, --shard, --workers,"
+	   << " --incremental, --baseline_db, --git_rev, --watch or --serve" 
+	   << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(db_infile!="" && 
+     (shard_count>0 || workers>1 || incremental || baseline_db!=""))
+    {
+      cerr << "--db_infile cannot be used with --shard, --workers,"
+	   << " --incremental or --baseline_db" << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(dedup_mode!="" && (merge_mode || workers>1 || report_only))
+    {
+      cerr << "--dedup cannot be used with --merge, --workers or --report_only"
+	   << endl;
+      PrintUsage(cerr);
+      exit(2);
+    }
+  if(report_only)
+    {
+      // the source listing is the one report which reads the sources
+      report_mask &= ~rtSOURCE;
+    }
+
   // we fill in defaults for things which have not been set
   if(outdir=="")
     {
@@ -247,6 +670,10 @@ void Main::HandleArgs(int argc, char **argv)
     {
       xml_outfile=outdir+"/cccc.xml";
     }
+  if(report_only && file_list.empty())
+    {
+      file_list.push_back(file_entry(db_outfile,""));
+    }
   if(opt_outfile=="")
     {
       opt_outfile=outdir+"/cccc.opt";
@@ -266,6 +693,46 @@ void Main::HandleArgs(int argc, char **argv)
     {
       CCCC_Options::Load_Options(opt_infile);
     }
+
+  // the cache keys depend on the options, so it is set up last
+  if(cache_dir!="")
+    {
+#ifdef _WIN32
+      _mkdir(cache_dir.c_str());
+#else
+      mkdir(cache_dir.c_str(),0777);
+#endif
+      cache.reset(new CCCC_ResultCache(cache_dir));
+    }
+
+  // the languages of the files in a revision depend on the options too
+  if(git_rev!="")
+    {
+      git_source.reset(new CCCC_GitSource(git_rev));
+      std::vector<string> paths;
+      if(!git_source->good())
+	{
+	  cerr << "Couldn't start git to read revision " << git_rev << endl;
+	  exit(2);
+	}
+      if(file_list.empty() && baseline_db=="")
+	{
+	  if(!git_source->ListFiles(paths))
+	    {
+	      cerr << "Couldn't list the files in revision " << git_rev << endl;
+	      exit(2);
+	    }
+	  for(size_t i=0; i<paths.size(); i++)
+	    {
+	      if(CCCC_Options::hasFileLanguage(paths[i]))
+		{
+		  file_list.push_back(file_entry(paths[i],lang));
+		}
+	    }
+	}
+      CCCC_GitSource::Install(git_source.get());
+    }
+  watched_files.assign(file_list.begin(),file_list.end());
 }
 
 void Main::AddFileArgument(const string& file_arg) 
@@ -335,167 +802,1971 @@ void Main::AddFileArgument(const string& file_arg)
 */
 int Main::ParseFiles() 
 {
-  FILE *f;
-  
-  std::list<file_entry>::iterator file_iterator=file_list.begin();
-  while(file_iterator!=file_list.end())
+  if((workers>1 || jobs>1) && file_list.size()>1)
     {
-	  const file_entry &entry=*file_iterator;
+      record_costs=true;
+      LoadCostHistory();
+    }
+  if(workers>1 && file_list.size()>1)
+    {
+      return ParseFilesInWorkers();
+    }
+  return ParseFilesInProcess();
+}
 
-      string filename=entry.first;
-      string file_language=entry.second;
-      ParseStore ps(filename);
+int Main::ParseFilesInProcess() 
+{
+  if(jobs>1 && file_list.size()>1)
+    {
+      return ParseFilesConcurrently();
+    }
 
-      // The following objects are used to assist in the parsing 
-      // process.
+  std::vector<string> filenames;
+  std::list<file_entry>::iterator file_iterator=file_list.begin();
+  while(file_iterator!=file_list.end())
+    {
+      filenames.push_back((*file_iterator).first);
+      file_iterator++;
+    }
+  std::unique_ptr<CCCC_SourcePrefetcher> prefetcher(StartPrefetch(filenames));
 
-      if(file_language.size()==0)
+  size_t file_index=0;
+  file_iterator=file_list.begin();
+  while(file_iterator!=file_list.end())
+    {
+      CCCC_Project::FileCost cost;
+      string source_text;
+      bool prefetched=
+	prefetcher.get()!=NULL && prefetcher->Take(file_index,source_text);
+      CCCC_Extent::set_key_block(KeyBlock(file_index));
+      file_index++;
+      if(ParseFile(*file_iterator,&cost,prefetched ? &source_text : NULL))
 	{
-	  file_language=CCCC_Options::getFileLanguage(filename);
+	  files_parsed++;
+	  if(record_costs)
+	    {
+	      prj->file_cost_table[(*file_iterator).first]=cost;
+	    }
 	}
+      file_iterator++;
+    }
+  CCCC_Extent::set_key_block(KeyBlock(file_index));
 
-      // CCCC supports a convention that the language may include an
-      // embedded '.', in which case the part before the . controls 
-      // which parser runs, while the whole can be examined inside
-      // the parser to check for special dialect handling.
-      unsigned int period_pos=file_language.find(".");
-      string base_language=file_language.substr(0,period_pos);
+  return 0;
+}
 
-      f=fopen(filename.c_str(),"r");
-      if( f == NULL ) 
-	{
-	  cerr << "Couldn't open " << filename << endl;
-	} else {
-	  DLGFileInput in(f);
+/*
+** method to start reading files ahead of the parsers
+*/
+CCCC_SourcePrefetcher *Main::StartPrefetch(const std::vector<string>& filenames)
+{
+  CCCC_SourcePrefetcher *retval=NULL;
+  if(prefetch_files>0 && filenames.size()>1)
+    {
+      retval=new CCCC_SourcePrefetcher(filenames,prefetch_files,
+				       prefetch_megabytes*1024*1024);
+    }
+  return retval;
+}
 
-	  // show progress 
-	  cerr << "Processing " << filename;
+/*
+** method to load the file costs recorded by the previous run
+*/
+void Main::LoadCostHistory()
+{
+  // The history comes from the database this run is about to replace,
+  // or failing that the one it was asked to preload.  We only want 
+  // the cost records, which come at the end, so we skim through the
+  // file looking for them rather than loading the whole database.
+  ifstream history_file(db_outfile.c_str());
+  if(!history_file && db_infile!="")
+    {
+      history_file.clear();
+      history_file.open(db_infile.c_str());
+    }
 
-	  // The first case is just to allow symetric handling
-	  // of the optional inclusion of support for each language
-	  if(0)
-	    {
-	    }
-#ifdef CC_INCLUDED
-	  else if(
-	     (base_language=="c++") ||
-	     (base_language=="c") 
+  string line;
+  string prefix=FILECOST_PREFIX+"@";
+  while(std::getline(history_file,line))
+    {
+      if(line.compare(0,prefix.size(),prefix)==0)
+	{
+	  CCCC_Item cost_line(line);
+	  string line_keyword_dummy, filename;
+	  CCCC_Project::FileCost cost;
+	  if(
+	     cost_line.Extract(line_keyword_dummy) &&
+	     cost_line.Extract(filename) &&
+	     cost_line.Extract(cost.tokens) &&
+	     cost_line.Extract(cost.parse_usec) &&
+	     cost_line.Extract(cost.bytes)
 	     )
 	    {
-	      cerr << " as C/C++ (" << file_language << ")" 
-		   << endl;
-
-	      CLexer theLexer(&in);
-	      ANTLRTokenBuffer thePipe(&theLexer);
-	      theLexer.setToken(&currentLexerToken);
-	      CParser theParser(&thePipe);
-	      ParseUtility pu(&theParser);
-
-	      theParser.init(filename,file_language);
-
-	      // This function turns of the annoying "guess failed" messages
-	      // every time a syntactic predicate fails.
-	      // This message is enabled by default when PCCTS is run with
-	      // tracing turned on (as it is by default in this application).
-	      // In the current case this is inappropriate as the C++ parser
-	      // uses guessing heavily to break ambiguities, and we expect 
-	      // large numbers of guesses to be tested and to fail.
-	      // This message and the flag which gates it were added around 
-	      // PCCTS 1.33 MR10. 
-	      // If you are building with an earlier version, this line should
-	      // cause an error and can safely be commented out.
-	      theParser.traceGuessOption(-1);
-
-	      theParser.start();
-              files_parsed++;
+	      cost_history[filename]=cost;
 	    }
-#endif // CC_INCLUDED
-#ifdef JAVA_INCLUDED
-	  else if(base_language=="java")
-	    {
-	      cerr << " as Java" << endl;
+	}
+    }
 
-	      JLexer theLexer(&in);
-	      ANTLRTokenBuffer thePipe(&theLexer);
-	      theLexer.setToken(&currentLexerToken);
-	      JParser theParser(&thePipe);
-	      theParser.init(filename,file_language);
-	      theParser.traceGuessOption(-1);
-	      theParser.compilationUnit();
-              files_parsed++;
-	    }
-#endif // JAVA_INCLUDED
-#ifdef ADA_INCLUDED
-	  else if(base_language=="ada")
-	    {
-	      cerr << " as Ada" << endl;
+  // Files without a history are costed by size, scaled so that the
+  // estimates are comparable with the measured times of the others.
+  double total_usec=0, total_bytes=0;
+  CCCC_Project::FileCostTable::iterator costIter;
+  for(costIter=cost_history.begin(); 
+      costIter!=cost_history.end(); 
+      ++costIter)
+    {
+      total_usec+=(*costIter).second.parse_usec;
+      total_bytes+=(*costIter).second.bytes;
+    }
+  if(total_usec>0 && total_bytes>0)
+    {
+      usec_per_byte=total_usec/total_bytes;
+    }
+}
 
-	      ALexer theLexer(&in);
-	      ANTLRTokenBuffer thePipe(&theLexer);
-	      theLexer.setToken(&currentLexerToken);
-	      AdaPrser theParser(&thePipe);
-	      theParser.init(filename,file_language);
-	      theParser.traceGuessOption(-1);
-	      theParser.goal_symbol();
-              files_parsed++;
-	    }
-#endif // ADA_INCLUDED
-	  else if(base_language=="")
-	  {
-		cerr << " - no parseable language identified";		
-	  }
-	  else
+/*
+** method to estimate the cost of parsing each of a list of files
+*/
+std::vector<double> Main::EstimateCosts(const std::vector<file_entry>& entries)
+{
+  std::vector<double> costs(entries.size(),0.0);
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      const string& filename=entries[i].first;
+      CCCC_Project::FileCostTable::iterator costIter=
+	cost_history.find(filename);
+      if(costIter!=cost_history.end() && (*costIter).second.parse_usec>0)
+	{
+	  costs[i]=(*costIter).second.parse_usec;
+	}
+      else
+	{
+	  struct stat file_status;
+	  if(stat(filename.c_str(),&file_status)==0)
 	    {
-	      cerr << "Unexpected language " << base_language.c_str()
-		   << " (" << file_language.c_str() 
-		   << ") for file " << filename.c_str() << endl;
+	      costs[i]=file_status.st_size*usec_per_byte;
 	    }
-
-	  // close the file
-	  fclose(f);
 	}
+    }
+  return costs;
+}
 
-      file_iterator++;
+/*
+** method to parse the supplied list of files on a number of threads
+*/
+int Main::ParseFilesConcurrently()
+{
+  // Each thread adds the records for the files it parses straight to 
+  // the database, which is dealt out into shards for the duration so 
+  // that the threads seldom wait for one another.  The extents from each 
+  // file are keyed by the file's place in the list, so the database ends
+  // up exactly as a serial run would have left it.
+  std::vector<file_entry> entries(file_list.begin(),file_list.end());
+
+  // The order in which the files are handed to the threads does not
+  // affect the outcome, so the most expensive are started first, to 
+  // stop a few big files at the end of the list from setting the
+  // overall time.
+  std::vector<double> estimated_costs=EstimateCosts(entries);
+  std::vector<size_t> dispatch_order(entries.size());
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      dispatch_order[i]=i;
+    }
+  std::stable_sort(dispatch_order.begin(),dispatch_order.end(),
+		   [&](size_t lhs, size_t rhs)
+		   { return estimated_costs[lhs]>estimated_costs[rhs]; });
+
+  std::vector<string> filenames;
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      filenames.push_back(entries[dispatch_order[i]].first);
+    }
+  std::unique_ptr<CCCC_SourcePrefetcher> prefetcher(StartPrefetch(filenames));
+
+  std::mutex dispatch_mutex;
+  size_t next_entry=0;
+
+  std::vector<std::thread> workers;
+  int worker_count=jobs;
+  if(static_cast<size_t>(worker_count)>entries.size())
+    {
+      worker_count=entries.size();
+    }
+  prj->begin_concurrent_ingestion();
+  for(int i=0; i<worker_count; i++)
+    {
+      workers.push_back(std::thread([&]()
+	{
+	  for(;;)
+	    {
+	      size_t this_position, this_entry;
+	      {
+		std::lock_guard<std::mutex> lock(dispatch_mutex);
+		if(next_entry==entries.size())
+		  {
+		    break;
+		  }
+		this_position=next_entry++;
+		this_entry=dispatch_order[this_position];
+	      }
+	      string source_text;
+	      bool prefetched=
+		prefetcher.get()!=NULL && 
+		prefetcher->Take(this_position,source_text);
+	      CCCC_Project::FileCost cost;
+	      CCCC_Extent::set_key_block(KeyBlock(this_entry));
+	      bool parsed=ParseFile(entries[this_entry],&cost,
+				    prefetched ? &source_text : NULL);
+	      if(parsed)
+		{
+		  std::lock_guard<std::mutex> lock(dispatch_mutex);
+		  files_parsed++;
+		  prj->file_cost_table[entries[this_entry].first]=cost;
+		}
+	    }
+	}));
     }
 
+  for(size_t i=0; i<workers.size(); i++)
+    {
+      workers[i].join();
+    }
+  prj->end_concurrent_ingestion();
+  CCCC_Extent::set_key_block(KeyBlock(entries.size()));
   return 0;
 }
 
-int Main::DumpDatabase()
+/*
+** method to restrict the file list to the requested shard
+*/
+void Main::SelectShard()
 {
-  ofstream outfile(db_outfile.c_str());
-  return prj->ToFile(outfile);
+  // The shard a file belongs to depends only on its path as given, so
+  // every agent running over the same file list makes the same choice.
+  // The path is hashed using 32 bit FNV-1a.
+  std::list<file_entry>::iterator file_iterator=file_list.begin();
+  while(file_iterator!=file_list.end())
+    {
+      const string& filename=(*file_iterator).first;
+      unsigned int hash=2166136261U;
+      for(size_t i=0; i<filename.size(); i++)
+	{
+	  hash^=static_cast<unsigned char>(filename[i]);
+	  hash*=16777619U;
+	}
+      if(hash%shard_count==static_cast<unsigned int>(shard_index))
+	{
+	  ++file_iterator;
+	}
+      else
+	{
+	  file_iterator=file_list.erase(file_iterator);
+	}
+    }
 }
 
-int Main::LoadDatabase()
+/*
+** method to work out the key block of a file from its place in the list
+*/
+unsigned int Main::KeyBlock(size_t index)
 {
-  int retval=0;
-  if(db_infile!="")
+  unsigned int retval=index+1;
+  if(!key_blocks.empty())
     {
-      ifstream infile(db_infile.c_str());
-      retval=prj->FromFile(infile);
+      retval=key_blocks[index];
     }
   return retval;
 }
 
-void Main::GenerateHtml()
+/*
+** method to hash the content of a file, returning an empty string if
+** the file can't be read
+*/
+string Main::FileHash(const file_entry& entry)
 {
-  cerr << endl << "Generating HTML reports" << endl;
-
-  CCCC_Html_Stream::GenerateReports(prj,report_mask,html_outfile,outdir);
-
+  // A file is hashed together with the language it is to be parsed as,
+  // so that a change of language also counts as a change.
+  string retval;
+  string text;
+  if(CCCC_SourceBuffer::ReadFile(entry.first,text))
+    {
+      retval=ContentHash(entry.second+"@"+text);
+    }
+  return retval;
 }
 
-void Main::GenerateXml()
+/*
+** method to bring the previous run's database up to date, and restrict
+** the file list to the files which have changed since that run
+*/
+void Main::SelectChangedFiles()
 {
-  cerr << endl << "Generating XML reports" << endl;
+  CCCC_DbInputStream previous_db(db_outfile);
+  if(previous_db)
+    {
+      cerr << "Loading " << db_outfile << endl;
+      prj->FromFile(previous_db);
+      if(prj->file_hash_table.empty())
+	{
+	  // without the hashes there is no telling which files the
+	  // records came from, or whether they have changed
+	  cerr << db_outfile << " was not saved by an incremental run" << endl;
+	  delete prj;
+	  prj=new CCCC_Project;
+	}
+    }
+  else
+    {
+      cerr << "No database from a previous run in " << db_outfile << endl;
+    }
 
-  CCCC_Xml_Stream::GenerateReports(prj,report_mask,xml_outfile,outdir);
+  std::vector<file_entry> entries(file_list.begin(),file_list.end());
+  std::vector<string> hashes(entries.size());
+  std::mutex hash_mutex;
+  size_t next_entry=0;
+  auto hash_files=[&]()
+    {
+      for(;;)
+	{
+	  size_t this_entry;
+	  {
+	    std::lock_guard<std::mutex> lock(hash_mutex);
+	    if(next_entry==entries.size())
+	      {
+		break;
+	      }
+	    this_entry=next_entry++;
+	  }
+	  hashes[this_entry]=FileHash(entries[this_entry]);
+	}
+    };
+  std::vector<std::thread> hashers;
+  for(int i=1; i<jobs && static_cast<size_t>(i)<entries.size(); i++)
+    {
+      hashers.push_back(std::thread(hash_files));
+    }
+  hash_files();
+  for(size_t i=0; i<hashers.size(); i++)
+    {
+      hashers[i].join();
+    }
 
-}
+  CCCC_Project::FileHashTable previous_hashes;
+  previous_hashes.swap(prj->file_hash_table);
+  prj->index_file_extents();
 
-void Main::HandleDebugOption(const string& arg) 
-{
+  std::map<string,unsigned int> file_blocks;
+  file_list.clear();
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      const string& filename=entries[i].first;
+      if(file_blocks.find(filename)!=file_blocks.end())
+	{
+	  // a file named twice is reused for both
+	  files_reused++;
+	  continue;
+	}
+
+      CCCC_Project::FileHashTable::iterator hashIter=
+	previous_hashes.find(filename);
+      if(
+	 hashes[i].size()>0 && hashIter!=previous_hashes.end() &&
+	 (*hashIter).second==hashes[i]
+	 )
+	{
+	  file_blocks[filename]=i+1;
+	  files_reused++;
+	}
+      else
+	{
+	  prj->purge_file(filename);
+	  file_list.push_back(entries[i]);
+	  key_blocks.push_back(i+1);
+	}
+      if(hashIter!=previous_hashes.end())
+	{
+	  previous_hashes.erase(hashIter);
+	}
+      if(hashes[i].size()>0)
+	{
+	  prj->file_hash_table[filename]=hashes[i];
+	}
+    }
+  key_blocks.push_back(entries.size()+1);
+
+  // the files left over were analyzed last time but are not listed now
+  CCCC_Project::FileHashTable::iterator hashIter;
+  for(hashIter=previous_hashes.begin(); 
+      hashIter!=previous_hashes.end(); 
+      ++hashIter)
+    {
+      prj->purge_file((*hashIter).first);
+    }
+
+  prj->remove_empty_records();
+  prj->rekey_extents(file_blocks);
+
+  cerr << files_reused << " of " << entries.size() 
+       << " files are unchanged since the previous run" << endl;
+}
+
+/*
+** method to bring a baseline database up to date with the changes git
+** reports since the revision it was saved at, and restrict the file 
+** list to the files which need to be parsed again
+*/
+void Main::SelectDeltaFiles()
+{
+  CCCC_DbInputStream baseline(baseline_db);
+  if(!baseline)
+    {
+      cerr << "Couldn't open baseline database " << baseline_db << endl;
+      exit(2);
+    }
+  cerr << "Loading " << baseline_db << endl;
+  prj->FromFile(baseline);
+
+  // hashes saved by an incremental run would not be kept up to date
+  prj->file_hash_table.clear();
+
+  string prefix;
+  std::map<string,char> file_status;
+  if(
+     !CCCC_GitSource::CurrentPrefix(prefix) ||
+     !CCCC_GitSource::DiffFiles(changed_from,git_rev,file_status)
+     )
+    {
+      cerr << "Couldn't find the files changed since " << changed_from 
+	   << endl;
+      exit(2);
+    }
+
+  prj->index_file_extents();
+
+  if(file_list.empty())
+    {
+      // The database does not record the order in which the files were
+      // listed, so they are taken in the order git lists them, which is
+      // that of their paths.
+      std::set<string> filenames;
+      CCCC_Project::FileExtentTable::iterator extIter;
+      for(extIter=prj->file_extent_table.begin();
+	  extIter!=prj->file_extent_table.end();
+	  extIter=prj->file_extent_table.upper_bound((*extIter).first))
+	{
+	  const string& filename=(*extIter).first;
+	  if(filename==BUILTIN_FILENAME)
+	    {
+	      continue;
+	    }
+	  std::map<string,char>::iterator statusIter=
+	    file_status.find(CCCC_GitSource::TopLevelPath(prefix,filename));
+	  if(statusIter==file_status.end() || (*statusIter).second!='D')
+	    {
+	      filenames.insert(filename);
+	    }
+	}
+
+      // files added below the current directory are included
+      std::map<string,char>::iterator statusIter;
+      for(statusIter=file_status.begin(); 
+	  statusIter!=file_status.end(); 
+	  ++statusIter)
+	{
+	  const string& path=(*statusIter).first;
+	  if(
+	     (*statusIter).second=='A' &&
+	     path.compare(0,prefix.size(),prefix)==0 &&
+	     CCCC_Options::hasFileLanguage(path)
+	     )
+	    {
+	      filenames.insert(path.substr(prefix.size()));
+	    }
+	}
+
+      std::set<string>::iterator nameIter;
+      for(nameIter=filenames.begin(); nameIter!=filenames.end(); ++nameIter)
+	{
+	  file_list.push_back(file_entry(*nameIter,lang));
+	}
+      watched_files.assign(file_list.begin(),file_list.end());
+    }
+
+  std::vector<file_entry> entries(file_list.begin(),file_list.end());
+  std::set<string> listed;
+  std::map<string,unsigned int> file_blocks;
+  file_list.clear();
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      const string& filename=entries[i].first;
+      if(listed.find(filename)!=listed.end())
+	{
+	  // a file named twice is reused for both
+	  files_reused++;
+	  continue;
+	}
+      listed.insert(filename);
+
+      bool changed=
+	file_status.find(CCCC_GitSource::TopLevelPath(prefix,filename))!=
+	file_status.end();
+      if(!changed && prj->file_extent_table.count(filename)>0)
+	{
+	  file_blocks[filename]=i+1;
+	  files_reused++;
+	}
+      else
+	{
+	  prj->purge_file(filename);
+	  file_list.push_back(entries[i]);
+	  key_blocks.push_back(i+1);
+	}
+    }
+  key_blocks.push_back(entries.size()+1);
+
+  // the files in the baseline which are not listed now are dropped
+  std::set<string> unlisted;
+  CCCC_Project::FileExtentTable::iterator extIter;
+  for(extIter=prj->file_extent_table.begin();
+      extIter!=prj->file_extent_table.end();
+      ++extIter)
+    {
+      if(
+	 listed.find((*extIter).first)==listed.end() &&
+	 (*extIter).first!=BUILTIN_FILENAME
+	 )
+	{
+	  unlisted.insert((*extIter).first);
+	}
+    }
+  std::set<string>::iterator unlistedIter;
+  for(unlistedIter=unlisted.begin(); 
+      unlistedIter!=unlisted.end(); 
+      ++unlistedIter)
+    {
+      prj->purge_file(*unlistedIter);
+    }
+
+  prj->remove_empty_records();
+  prj->rekey_extents(file_blocks);
+
+  cerr << files_reused << " of " << entries.size() 
+       << " files are unchanged since " << changed_from << endl;
+}
+
+/*
+** method to restrict the file list to the first file with each content
+*/
+void Main::SelectDistinctFiles()
+{
+  // The files are hashed on --jobs threads, together with the language 
+  // each is to be parsed as, and the length of the text is added to 
+  // the hash, as for a cache key.
+  std::vector<file_entry> entries(file_list.begin(),file_list.end());
+  std::vector<string> keys(entries.size());
+  std::mutex hash_mutex;
+  size_t next_entry=0;
+  auto hash_files=[&]()
+    {
+      for(;;)
+	{
+	  size_t this_entry;
+	  {
+	    std::lock_guard<std::mutex> lock(hash_mutex);
+	    if(next_entry==entries.size())
+	      {
+		break;
+	      }
+	    this_entry=next_entry++;
+	  }
+	  const file_entry& entry=entries[this_entry];
+	  string language=entry.second;
+	  if(language.size()==0)
+	    {
+	      language=CCCC_Options::getFileLanguage(entry.first);
+	    }
+	  string text;
+	  if(CCCC_SourceBuffer::ReadFile(entry.first,text))
+	    {
+	      ostringstream key;
+	      key << ContentHash(language+"@"+text) << "-" << text.size();
+	      keys[this_entry]=key.str();
+	    }
+	}
+    };
+  std::vector<std::thread> hashers;
+  for(int i=1; i<jobs && static_cast<size_t>(i)<entries.size(); i++)
+    {
+      hashers.push_back(std::thread(hash_files));
+    }
+  hash_files();
+  for(size_t i=0; i<hashers.size(); i++)
+    {
+      hashers[i].join();
+    }
+
+  // A file is only taken to be a copy of an earlier one with the same
+  // key if their texts are the same byte for byte.
+  std::map<string,size_t> first_with_key;
+  std::vector<unsigned int> distinct_blocks;
+  file_list.clear();
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      std::map<string,size_t>::iterator keyIter=first_with_key.end();
+      if(keys[i].size()>0)
+	{
+	  keyIter=first_with_key.find(keys[i]);
+	}
+
+      string original_text, text;
+      if(
+	 keyIter!=first_with_key.end() &&
+	 CCCC_SourceBuffer::ReadFile(entries[(*keyIter).second].first,
+				     original_text) &&
+	 CCCC_SourceBuffer::ReadFile(entries[i].first,text) &&
+	 text==original_text
+	 )
+	{
+	  DuplicateFile duplicate;
+	  duplicate.entry=entries[i];
+	  duplicate.key_block=KeyBlock(i);
+	  duplicate.original=entries[(*keyIter).second].first;
+	  duplicate_files.push_back(duplicate);
+	  if(dedup_mode=="path")
+	    {
+	      retained_files.insert(duplicate.original);
+	    }
+	}
+      else
+	{
+	  if(keys[i].size()>0 && keyIter==first_with_key.end())
+	    {
+	      first_with_key[keys[i]]=i;
+	    }
+	  file_list.push_back(entries[i]);
+	  distinct_blocks.push_back(KeyBlock(i));
+	}
+    }
+  distinct_blocks.push_back(KeyBlock(entries.size()));
+  key_blocks.swap(distinct_blocks);
+
+  cerr << duplicate_files.size() << " of " << entries.size() 
+       << " files are copies of files before them";
+  if(dedup_mode=="once")
+    {
+      cerr << ", and are counted once" << endl;
+    }
+  else
+    {
+      cerr << ", and share their records" << endl;
+    }
+}
+
+/*
+** method to record the records found in a file which has copies
+*/
+void Main::RetainRecords(const string& filename, 
+			 const ParseRecordList& records)
+{
+  std::lock_guard<std::mutex> lock(retained_mutex);
+  retained_records[filename]=records;
+}
+
+/*
+** method to pass on the records of each file with copies again for 
+** each of the copies, as if it had been parsed
+*/
+void Main::CopyDuplicateRecords()
+{
+  if(!retained_files.empty())
+    {
+      std::vector<DuplicateFile>::iterator duplicateIter;
+      for(duplicateIter=duplicate_files.begin(); 
+	  duplicateIter!=duplicate_files.end(); 
+	  ++duplicateIter)
+	{
+	  std::map<string,ParseRecordList>::iterator recordsIter=
+	    retained_records.find((*duplicateIter).original);
+	  if(recordsIter!=retained_records.end())
+	    {
+	      ParseRecordList records=(*recordsIter).second;
+	      ParseStore::rename_records(records,(*duplicateIter).entry.first);
+	      CCCC_Extent::set_key_block((*duplicateIter).key_block);
+	      ParseStore::add_records_to_project(records);
+	      files_reused++;
+	    }
+	}
+      CCCC_Extent::set_key_block(KeyBlock(file_list.size()));
+    }
+  duplicate_files.clear();
+  retained_files.clear();
+  retained_records.clear();
+}
+
+/*
+** method to load the database fragments named on the command line
+*/
+int Main::MergeDatabases()
+{
+  std::list<file_entry>::iterator file_iterator=file_list.begin();
+  while(file_iterator!=file_list.end())
+    {
+      const string& filename=(*file_iterator).first;
+      cerr << (report_only ? "Loading " : "Merging ") << filename << endl;
+      if(MergeDatabase(filename))
+	{
+	  databases_merged++;
+	}
+      ++file_iterator;
+    }
+  return 0;
+}
+
+/*
+** method to parse the supplied list of files in a number of child processes
+*/
+int Main::ParseFilesInWorkers()
+{
+#ifdef _WIN32
+  cerr << "Worker processes are not supported on this platform, "
+       << "parsing in a single process" << endl;
+  return ParseFilesInProcess();
+#else
+  std::vector<file_entry> entries(file_list.begin(),file_list.end());
+  size_t worker_count=workers;
+  if(worker_count>entries.size())
+    {
+      worker_count=entries.size();
+    }
+
+  // the fragments are written to the output directory
+  MakeOutputDirectory();
+
+  // The slices have to be contiguous for the merged database to come
+  // out as a serial run would leave it, so rather than reordering the
+  // files we choose the slice boundaries to give each worker a similar
+  // share of the estimated cost.
+  std::vector<double> estimated_costs=EstimateCosts(entries);
+  double total_cost=0;
+  for(size_t i=0; i<entries.size(); i++)
+    {
+      total_cost+=estimated_costs[i];
+    }
+
+  std::vector<WorkerProcess> worker_processes;
+  size_t first=0;
+  double cost_so_far=0;
+  for(size_t i=0; i<worker_count; i++)
+    {
+      // each slice must leave at least one file for each later slice
+      size_t last=first+1;
+      cost_so_far+=estimated_costs[first];
+      double slice_target=total_cost*(i+1)/worker_count;
+      while(
+	    last<entries.size()-(worker_count-1-i) &&
+	    cost_so_far+estimated_costs[last]/2<=slice_target
+	    )
+	{
+	  cost_so_far+=estimated_costs[last];
+	  last++;
+	}
+      if(i==worker_count-1)
+	{
+	  last=entries.size();
+	}
+
+      ostringstream fragment;
+      fragment << outdir << "/cccc_worker" << i << ".db";
+      worker_processes.push_back(
+	StartWorker(entries,first,last,fragment.str()));
+      first=last;
+    }
+
+  // The fragments are merged in the order of the slices, which is the
+  // order in which the files were given, so the merged database has 
+  // its extents in the same order as a serial run would create them.
+  for(size_t i=0; i<worker_count; i++)
+    {
+      WorkerProcess& worker=worker_processes[i];
+      if(FinishWorker(entries,worker)==false && worker.last-worker.first>1)
+	{
+	  // One pathological file should not cost us the results for all
+	  // of the others in its slice, so we try them again, each in a 
+	  // process of its own.
+	  cerr << "Retrying the " << worker.last-worker.first 
+	       << " files from " << entries[worker.first].first
+	       << " to " << entries[worker.last-1].first 
+	       << " one at a time" << endl;
+	  for(size_t j=worker.first; j<worker.last; j++)
+	    {
+	      ostringstream fragment;
+	      fragment << outdir << "/cccc_worker" << i << "_" << j << ".db";
+	      WorkerProcess retry=StartWorker(entries,j,j+1,fragment.str());
+	      FinishWorker(entries,retry);
+	    }
+	}
+    }
+  return 0;
+#endif
+}
+
+/*
+** method to start a child process to parse a slice of the file list
+*/
+Main::WorkerProcess Main::StartWorker(const std::vector<file_entry>& entries,
+				      size_t first, size_t last,
+				      const string& fragment)
+{
+  WorkerProcess worker;
+  worker.pid=-1;
+  worker.result_fd=-1;
+  worker.first=first;
+  worker.last=last;
+  worker.fragment=fragment;
+
+#ifndef _WIN32
+  // The child reports the number of files it parsed through a pipe.
+  int result_pipe[2];
+  if(pipe(result_pipe)!=0)
+    {
+      cerr << "Couldn't create pipe for worker process" << endl;
+      return worker;
+    }
+
+  // anything still buffered would otherwise be written twice
+  cout.flush();
+  cerr.flush();
+
+  worker.pid=fork();
+  if(worker.pid==0)
+    {
+      close(result_pipe[0]);
+      file_list.assign(entries.begin()+first,entries.begin()+last);
+      files_parsed=0;
+      ParseFilesInProcess();
+
+      ofstream fragment_file(fragment.c_str());
+      prj->ToFile(fragment_file);
+      fragment_file.close();
+
+      int exit_status=1;
+      if(fragment_file.good())
+	{
+	  char result_buffer[32];
+	  sprintf(result_buffer,"%d\n",files_parsed);
+	  if(write(result_pipe[1],result_buffer,strlen(result_buffer))>0)
+	    {
+	      exit_status=0;
+	    }
+	}
+      cout.flush();
+      cerr.flush();
+      _exit(exit_status);
+    }
+
+  close(result_pipe[1]);
+  if(worker.pid<0)
+    {
+      cerr << "Couldn't start worker process" << endl;
+      close(result_pipe[0]);
+    }
+  else
+    {
+      worker.result_fd=result_pipe[0];
+    }
+#endif
+  return worker;
+}
+
+/*
+** method to wait for a child process and merge its fragment
+** returns false if the child did not complete its slice
+*/
+bool Main::FinishWorker(const std::vector<file_entry>& entries,
+			WorkerProcess& worker)
+{
+  bool retval=false;
+#ifndef _WIN32
+  if(worker.pid<0)
+    {
+      // we could not start a process, so the slice is parsed here
+      std::list<file_entry> saved_file_list;
+      saved_file_list.swap(file_list);
+      file_list.assign(entries.begin()+worker.first,
+		       entries.begin()+worker.last);
+      ParseFilesInProcess();
+      file_list.swap(saved_file_list);
+      return true;
+    }
+
+  string result;
+  char result_buffer[32];
+  ssize_t bytes_read;
+  while((bytes_read=read(worker.result_fd,result_buffer,
+			 sizeof(result_buffer)))>0)
+    {
+      result.append(result_buffer,bytes_read);
+    }
+  close(worker.result_fd);
+
+  int status=0;
+  waitpid(worker.pid,&status,0);
+  if(WIFEXITED(status) && WEXITSTATUS(status)==0 && result.size()>0)
+    {
+      files_parsed+=atoi(result.c_str());
+      MergeDatabase(worker.fragment);
+      retval=true;
+    }
+  else if(WIFSIGNALED(status))
+    {
+      cerr << "Worker process for " << entries[worker.first].first;
+      if(worker.last-worker.first>1)
+	{
+	  cerr << " to " << entries[worker.last-1].first;
+	}
+      cerr << " was killed by signal " << WTERMSIG(status) << endl;
+    }
+  else
+    {
+      cerr << "Worker process for " << entries[worker.first].first;
+      if(worker.last-worker.first>1)
+	{
+	  cerr << " to " << entries[worker.last-1].first;
+	}
+      cerr << " failed" << endl;
+    }
+  unlink(worker.fragment.c_str());
+#endif
+  return retval;
+}
+
+/*
+** function run on a thread of its own to lex a file ahead of the parser
+*/
+template <class Lexer>
+static void LexAhead(DLGInputStream *in, const string& filename, 
+		     const string& language, ANTLRTokenType eof_type,
+		     TokenQueue *queue)
+{
+  // The running state of the lexer, and the dialect it consults, are 
+  // kept per thread, so they must be set up here.  The line counts it
+  // reports are collected by a store of its own, and passed on to the
+  // parser's store with the tokens.
+  parse_language=language;
+  ANTLRToken::ResetRunningState();
+  ParseStore counts(filename);
+
+  Lexer theLexer(in);
+  theLexer.setToken(&currentLexerToken);
+  for(;;)
+    {
+      ANTLRToken *tok=MY_TOK(theLexer.getToken());
+      bool is_last=(tok->getType()==eof_type);
+      if(!queue->put(tok,counts,is_last) || is_last)
+	{
+	  break;
+	}
+    }
+}
+
+/*
+** method to run a parser over a file
+*/
+template <class Lexer, class Parser>
+void Main::RunParser(DLGInputStream& in, 
+		     const string& filename, const string& language, 
+		     void (Parser::*start_rule)())
+{
+  if(pipeline)
+    {
+      TokenQueue queue;
+      ANTLRTokenBuffer thePipe(&queue);
+      Parser theParser(&thePipe);
+      ParseUtility pu(&theParser);
+
+      // init() already looks ahead, so the lexer must be running first.
+      std::thread lexer_thread(LexAhead<Lexer>,&in,filename,language,
+			       theParser.getEofToken(),&queue);
+      theParser.init(filename,language);
+      theParser.traceGuessOption(-1);
+      (theParser.*start_rule)();
+      queue.close();
+      lexer_thread.join();
+    }
+  else
+    {
+      Lexer theLexer(&in);
+      ANTLRTokenBuffer thePipe(&theLexer);
+      theLexer.setToken(&currentLexerToken);
+      Parser theParser(&thePipe);
+      ParseUtility pu(&theParser);
+
+      theParser.init(filename,language);
+
+      // This function turns of the annoying "guess failed" messages
+      // every time a syntactic predicate fails.
+      // This message is enabled by default when PCCTS is run with
+      // tracing turned on (as it is by default in this application).
+      // In the current case this is inappropriate as the C++ parser
+      // uses guessing heavily to break ambiguities, and we expect 
+      // large numbers of guesses to be tested and to fail.
+      // This message and the flag which gates it were added around 
+      // PCCTS 1.33 MR10. 
+      // If you are building with an earlier version, this line should
+      // cause an error and can safely be commented out.
+      theParser.traceGuessOption(-1);
+
+      (theParser.*start_rule)();
+    }
+}
+
+/*
+** method to parse a single file
+** returns true if a parser was run over the file
+*/
+bool Main::ParseFile(const file_entry& entry, 
+		     CCCC_Project::FileCost *cost, const string *source_text)
+{
+  // progress messages from concurrent parsers are assembled into 
+  // whole lines before they are written, so they do not get mixed up
+  static std::mutex progress_mutex;
+  bool retval=false;
+  FILE *f;
+
+  string filename=entry.first;
+  string file_language=entry.second;
+
+  // With a cache, the records found in the file are held back until
+  // they have been saved there, and for a file with duplicates, until
+  // they have been copied.
+  bool retain_records=
+    !retained_files.empty() && retained_files.count(filename)>0;
+  ParseRecordList parsed_records;
+  ParseStore ps(filename,
+		(cache.get()!=NULL || retain_records) ? &parsed_records : NULL);
+
+  // The following objects are used to assist in the parsing 
+  // process.
+
+  if(file_language.size()==0)
+    {
+      file_language=CCCC_Options::getFileLanguage(filename);
+    }
+
+  // CCCC supports a convention that the language may include an
+  // embedded '.', in which case the part before the . controls 
+  // which parser runs, while the whole can be examined inside
+  // the parser to check for special dialect handling.
+  unsigned int period_pos=file_language.find(".");
+  string base_language=file_language.substr(0,period_pos);
+
+  // With a cache, the file is read into memory to work out its key,
+  // and if it has been seen before its records are taken from there.
+  string file_text;
+  string cache_key;
+  if(cache.get()!=NULL)
+    {
+      if(source_text==NULL && CCCC_SourceBuffer::ReadFile(filename,file_text))
+	{
+	  source_text=&file_text;
+	}
+      if(source_text!=NULL)
+	{
+	  cache_key=cache->Key(*source_text,file_language);
+	  if(cache->Load(cache_key,filename,parsed_records))
+	    {
+	      {
+		std::lock_guard<std::mutex> lock(progress_mutex);
+		cerr << "Processing " << filename << " from the cache" << endl;
+	      }
+	      if(retain_records)
+		{
+		  RetainRecords(filename,parsed_records);
+		}
+	      ParseStore::add_records_to_project(parsed_records);
+	      if(cost!=NULL)
+		{
+		  cost->bytes=source_text->size();
+		}
+	      return true;
+	    }
+	}
+    }
+
+  // A C/C++ file which may be big enough to split is read into memory,
+  // so we can see how long it is before we start.
+  bool is_c_family=(base_language=="c++" || base_language=="c");
+  if(
+     source_text==NULL && split_lines>0 && is_c_family &&
+     CCCC_SourceBuffer::ReadFile(filename,file_text)
+     )
+    {
+      source_text=&file_text;
+    }
+
+  // If the text of the file has already been read, we lex it from
+  // memory, otherwise we read the file as we go.
+  f=NULL;
+  if(source_text==NULL)
+    {
+      f=fopen(filename.c_str(),"r");
+    }
+  if( f == NULL && source_text == NULL ) 
+    {
+      std::lock_guard<std::mutex> lock(progress_mutex);
+      cerr << "Couldn't open " << filename << endl;
+    } else {
+      std::unique_ptr<DLGInputStream> input_stream;
+      if(source_text!=NULL)
+	{
+	  input_stream.reset(new CCCC_SourceBuffer(*source_text));
+	}
+      else
+	{
+	  input_stream.reset(new DLGFileInput(f));
+	}
+      DLGInputStream& in=*input_stream;
+      ANTLRToken::ResetRunningState();
+      std::chrono::steady_clock::time_point start_time=
+	std::chrono::steady_clock::now();
+
+      // show progress 
+      ostringstream progress;
+      progress << "Processing " << filename;
+
+      // The first case is just to allow symetric handling
+      // of the optional inclusion of support for each language
+      if(0)
+	{
+	}
+#ifdef CC_INCLUDED
+      else if(
+	      (base_language=="c++") ||
+	      (base_language=="c") 
+	      )
+	{
+	  progress << " as C/C++ (" << file_language << ")" 
+		   << endl;
+	  {
+	    std::lock_guard<std::mutex> lock(progress_mutex);
+	    cerr << progress.str();
+	  }
+
+	  if(
+	     split_lines>0 && source_text!=NULL &&
+	     std::count(source_text->begin(),source_text->end(),'\n')
+	     >= 2*split_lines
+	     )
+	    {
+	      ParseFileInFragments(filename,file_language,in,ps);
+	      retval=true;
+	    }
+	  else
+	    {
+	      RunParser<CLexer,CParser>(in,filename,file_language,
+					&CParser::start);
+	      retval=true;
+	    }
+	}
+#endif // CC_INCLUDED
+#ifdef JAVA_INCLUDED
+      else if(base_language=="java")
+	{
+	  progress << " as Java" << endl;
+	  {
+	    std::lock_guard<std::mutex> lock(progress_mutex);
+	    cerr << progress.str();
+	  }
+
+	  RunParser<JLexer,JParser>(in,filename,file_language,
+				    &JParser::compilationUnit);
+	  retval=true;
+	}
+#endif // JAVA_INCLUDED
+#ifdef ADA_INCLUDED
+      else if(base_language=="ada")
+	{
+	  progress << " as Ada" << endl;
+	  {
+	    std::lock_guard<std::mutex> lock(progress_mutex);
+	    cerr << progress.str();
+	  }
+
+	  RunParser<ALexer,AdaPrser>(in,filename,file_language,
+				     &AdaPrser::goal_symbol);
+	  retval=true;
+	}
+#endif // ADA_INCLUDED
+      else if(base_language=="")
+	{
+	  progress << " - no parseable language identified";		
+	  std::lock_guard<std::mutex> lock(progress_mutex);
+	  cerr << progress.str();
+	}
+      else
+	{
+	  progress << "Unexpected language " << base_language.c_str()
+		   << " (" << file_language.c_str() 
+		   << ") for file " << filename.c_str() << endl;
+	  std::lock_guard<std::mutex> lock(progress_mutex);
+	  cerr << progress.str();
+	}
+
+      if(cost!=NULL)
+	{
+	  cost->tokens=ANTLRToken::RunningTokenCount;
+	  cost->parse_usec=std::chrono::duration_cast<std::chrono::microseconds>(
+	    std::chrono::steady_clock::now()-start_time).count();
+	  cost->bytes=(f!=NULL) ? ftell(f) : source_text->size();
+	}
+
+      // close the file
+      if(f!=NULL)
+	{
+	  fclose(f);
+	}
+    }
+
+  if(cache.get()!=NULL && retval && cache_key.size()>0)
+    {
+      cache->Save(cache_key,parsed_records);
+    }
+  if(retain_records && retval)
+    {
+      RetainRecords(filename,parsed_records);
+    }
+  if(cache.get()!=NULL || retain_records)
+    {
+      ParseStore::add_records_to_project(parsed_records);
+    }
+
+  return retval;
+}
+
+#ifdef CC_INCLUDED
+/*
+** method to parse a C/C++ file in fragments on several threads
+*/
+void Main::ParseFileInFragments(const string& filename, const string& language,
+				DLGInputStream& in, ParseStore& ps)
+{
+  // The whole file is lexed first, so that we can find the boundaries
+  // between top level declarations.  The line counts reported by the
+  // lexer go into the store for the whole file, and are taken from 
+  // there into the lexed file, token by token.  The lexer consults
+  // the language for dialect specific keywords, which would normally
+  // have been set up by the parser.
+  parse_language=language;
+  LexedFile lexed;
+  {
+    CLexer theLexer(&in);
+    theLexer.setToken(&currentLexerToken);
+    for(;;)
+      {
+	ANTLRToken *tok=MY_TOK(theLexer.getToken());
+	lexed.append(tok,ps);
+	if(CParser::isEndOfFile(tok))
+	  {
+	    break;
+	  }
+      }
+  }
+
+  // Each fragment but the last runs from a boundary between top level
+  // declarations to the first boundary at least split_lines further on.
+  std::vector<size_t> fragment_starts(1,0);
+  int fragment_start_line=lexed.token(0)->getLine();
+  for(size_t i=0; i+1<lexed.size(); i++)
+    {
+      ANTLRToken *tok=lexed.token(i), *next_tok=lexed.token(i+1);
+      if(
+	 next_tok->getLine()-fragment_start_line>=split_lines &&
+	 CParser::isFragmentBoundary(tok,next_tok)
+	 )
+	{
+	  fragment_starts.push_back(i+1);
+	  fragment_start_line=next_tok->getLine();
+	}
+    }
+  fragment_starts.push_back(lexed.size()-1);
+  size_t fragment_count=fragment_starts.size()-1;
+
+  std::vector<ParseRecordList> records(fragment_count);
+  std::vector<LineCountList> unallocated(fragment_count);
+  std::vector<int> errors(fragment_count,0);
+  std::vector<ostringstream> diagnostics(fragment_count);
+
+  // The parse store carries a few flags from one declaration to the 
+  // next, so a fragment can only be relied upon if it started with the
+  // flags the previous fragment finished with.  We start every fragment
+  // with the flags of a new store, and then parse again any fragment 
+  // which turns out to have started with the wrong ones, until they 
+  // all agree.  Usually the flags settle down after the first fragment
+  // or two, so only a few need a second parse.
+  std::vector<string> initial_flags(fragment_count,string(ps.flags()));
+  std::vector<string> final_flags(fragment_count);
+  std::vector<size_t> pending_fragments;
+  for(size_t i=0; i<fragment_count; i++)
+    {
+      pending_fragments.push_back(i);
+    }
+
+  while(pending_fragments.size()>0)
+    {
+      std::mutex fragment_mutex;
+      size_t next_fragment=0;
+      std::vector<std::thread> threads;
+      size_t thread_count=
+	std::min(static_cast<size_t>(jobs),pending_fragments.size());
+      for(size_t t=0; t<thread_count; t++)
+	{
+	  threads.push_back(std::thread([&]()
+	    {
+	      for(;;)
+		{
+		  size_t i;
+		  {
+		    std::lock_guard<std::mutex> lock(fragment_mutex);
+		    if(next_fragment==pending_fragments.size())
+		      {
+			break;
+		      }
+		    i=pending_fragments[next_fragment++];
+		  }
+		  ParseRecordList().swap(records[i]);
+		  unallocated[i].clear();
+		  diagnostics[i].str("");
+		  errors[i]=ParseFragment(lexed,fragment_starts[i],
+					  fragment_starts[i+1],
+					  filename,language,
+					  initial_flags[i],records[i],
+					  unallocated[i],final_flags[i],
+					  diagnostics[i]);
+		}
+	    }));
+	}
+      for(size_t t=0; t<threads.size(); t++)
+	{
+	  threads[t].join();
+	}
+
+      pending_fragments.clear();
+      for(size_t i=1; i<fragment_count; i++)
+	{
+	  if(initial_flags[i]!=final_flags[i-1])
+	    {
+	      initial_flags[i]=final_flags[i-1];
+	      pending_fragments.push_back(i);
+	    }
+	}
+    }
+
+  // Syntax errors in a fragment are most likely to be caused by a 
+  // boundary which was not after all between two declarations, so the 
+  // diagnostics are held back, and if there are any, the whole file is
+  // parsed again as a single fragment.
+  if(std::count(errors.begin(),errors.end(),0)!=
+     static_cast<std::ptrdiff_t>(fragment_count))
+    {
+      records.assign(1,ParseRecordList());
+      unallocated.assign(1,LineCountList());
+      final_flags.assign(1,string());
+      std::thread([&]()
+	{
+	  ParseFragment(lexed,0,lexed.size()-1,filename,language,
+			initial_flags[0],records[0],unallocated[0],
+			final_flags[0],cerr);
+	}).join();
+    }
+
+  // The file scope extent is recorded last, as it is at the end of a 
+  // parse of the whole file.
+  for(size_t i=0; i<records.size(); i++)
+    {
+      ps.commit_records(records[i]);
+      ps.add_line_counts(unallocated[i].begin(),unallocated[i].end());
+    }
+  ps.restore_flags(final_flags.back());
+  ps.record_file_scope_extent(lexed.token(lexed.size()-1)->getLine());
+}
+
+/*
+** method to parse one fragment of a C/C++ file, on a thread of its own
+*/
+int Main::ParseFragment(const LexedFile& lexed, size_t first, size_t last,
+			const string& filename, const string& language,
+			const string& initial_flags, ParseRecordList& records, 
+			LineCountList& unallocated, string& final_flags, 
+			ostream& err)
+{
+  ParseStore ps(filename,&records);
+  ps.set_fragment(true);
+  ps.restore_flags(initial_flags);
+
+  TokenReplay replay(lexed,first,last);
+  ANTLRTokenBuffer thePipe(&replay);
+  CParser theParser(&thePipe);
+  ParseUtility pu(&theParser);
+  pu.set_error_stream(err);
+
+  theParser.init(filename,language);
+  theParser.traceGuessOption(-1);
+  theParser.start();
+
+  ps.take_line_counts(unallocated);
+  final_flags=ps.flags();
+  return pu.errors();
+}
+#endif // CC_INCLUDED
+
+int Main::DumpDatabase()
+{
+  ofstream outfile(db_outfile.c_str());
+  return prj->ToFile(outfile);
+}
+
+bool Main::MergeDatabase(const string& filename)
+{
+  CCCC_DbInputStream infile(filename);
+  if(!infile)
+    {
+      cerr << "Couldn't open database file " << filename << endl;
+      return false;
+    }
+  prj->FromFile(infile);
+  return true;
+}
+
+void Main::MakeOutputDirectory()
+{
+#ifdef _WIN32
+  _mkdir(outdir.c_str());
+#else
+  mkdir(outdir.c_str(),0777);
+#endif
+}
+
+int Main::LoadDatabase()
+{
+  int retval=0;
+  if(db_infile!="")
+    {
+      cerr << "Loading " << db_infile << endl;
+      if(MergeDatabase(db_infile))
+	{
+	  databases_merged++;
+	  retval=1;
+	}
+    }
+  return retval;
+}
+
+void Main::SaveResults()
+{
+  if(report_only)
+    {
+      // the databases the reports come from are left as they were
+      prj->reindex(jobs);
+      MakeOutputDirectory();
+    }
+  else if(incremental)
+    {
+      // The database is saved before reindexing, as it is for a shard,
+      // so that the next incremental run can bring it up to date.
+      MakeOutputDirectory();
+      DumpDatabase();
+      prj->reindex(jobs);
+    }
+  else
+    {
+      prj->reindex(jobs);
+      MakeOutputDirectory();
+      DumpDatabase();
+    }
+
+  // generate html and xml output
+  GenerateReports();
+}
+
+/*
+** method to watch the listed files, and bring the results up to date
+** each time any of them changes
+*/
+void Main::Watch()
+{
+#ifdef __linux__
+  int inotify_fd=inotify_init1(IN_CLOEXEC);
+  if(inotify_fd<0)
+    {
+      cerr << "Couldn't start watching for changes" << endl;
+      return;
+    }
+
+  // Editors often save a file by writing a new one and renaming it over
+  // the old, so it is the directories holding the files which are 
+  // watched, and the events are matched to the files by name.
+  std::map<string,int> directory_watches;
+  typedef std::pair<int,string> watched_name;
+  std::map< watched_name, std::vector<size_t> > entries_by_name;
+  for(size_t i=0; i<watched_files.size(); i++)
+    {
+      const string& filename=watched_files[i].first;
+      size_t slash_pos=filename.find_last_of('/');
+      string directory=".";
+      if(slash_pos!=string::npos)
+	{
+	  directory=filename.substr(0,(slash_pos>0) ? slash_pos : 1);
+	}
+      string name=filename.substr(slash_pos+1);
+
+      std::map<string,int>::iterator dirIter=directory_watches.find(directory);
+      if(dirIter==directory_watches.end())
+	{
+	  int wd=inotify_add_watch(inotify_fd,directory.c_str(),
+				   IN_CLOSE_WRITE|IN_MOVED_TO|IN_MOVED_FROM|
+				   IN_CREATE|IN_DELETE);
+	  if(wd<0)
+	    {
+	      cerr << "Couldn't watch " << directory << endl;
+	    }
+	  dirIter=directory_watches.insert(std::make_pair(directory,wd)).first;
+	}
+      entries_by_name[watched_name((*dirIter).second,name)].push_back(i);
+    }
+
+  cerr << "Watching " << watched_files.size() << " files for changes" 
+       << endl;
+
+  // An editor may touch a file several times in saving it, and a number
+  // of files may be changed together, so once something has changed we
+  // wait until things have been quiet for a moment before updating.
+  const int settle_msec=100;
+  for(;;)
+    {
+      std::set<size_t> changed;
+      int timeout_msec=-1;
+      for(;;)
+	{
+	  struct pollfd inotify_poll;
+	  inotify_poll.fd=inotify_fd;
+	  inotify_poll.events=POLLIN;
+	  inotify_poll.revents=0;
+	  int ready=poll(&inotify_poll,1,timeout_msec);
+	  if(ready<0 && errno==EINTR)
+	    {
+	      continue;
+	    }
+	  if(ready<=0)
+	    {
+	      break;
+	    }
+
+	  char buffer[65536] 
+	    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	  ssize_t length=read(inotify_fd,buffer,sizeof(buffer));
+	  if(length<=0)
+	    {
+	      break;
+	    }
+	  for(char *ptr=buffer; ptr<buffer+length; )
+	    {
+	      const struct inotify_event *event=
+		reinterpret_cast<const struct inotify_event*>(ptr);
+	      if(event->len>0)
+		{
+		  std::map< watched_name, std::vector<size_t> >::iterator 
+		    nameIter=entries_by_name.find(
+		      watched_name(event->wd,string(event->name)));
+		  if(nameIter!=entries_by_name.end())
+		    {
+		      changed.insert((*nameIter).second.begin(),
+				     (*nameIter).second.end());
+		    }
+		}
+	      ptr+=sizeof(struct inotify_event)+event->len;
+	    }
+	  if(changed.size()>0)
+	    {
+	      timeout_msec=settle_msec;
+	    }
+	}
+
+      if(changed.size()>0)
+	{
+	  UpdateFiles(changed);
+	}
+    }
+#else
+  cerr << "Watching for changes is not supported on this platform" << endl;
+#endif
+}
+
+/*
+** method to bring the results up to date after some files have changed
+*/
+void Main::UpdateFiles(const std::set<size_t>& changed)
+{
+  std::chrono::steady_clock::time_point start_time=
+    std::chrono::steady_clock::now();
+  cerr << endl << "Updating " << changed.size() << " changed files" << endl;
+
+  // The records from the changed files are purged, in the same way as 
+  // for an incremental run, and the files are parsed again with their 
+  // extents keyed by their places in the full list.
+  prj->unindex();
+  prj->index_file_extents();
+  file_list.clear();
+  key_blocks.clear();
+  std::set<size_t>::const_iterator changeIter;
+  for(changeIter=changed.begin(); changeIter!=changed.end(); ++changeIter)
+    {
+      const file_entry& entry=watched_files[*changeIter];
+      prj->purge_file(entry.first);
+      file_list.push_back(entry);
+      key_blocks.push_back(*changeIter+1);
+    }
+  key_blocks.push_back(watched_files.size()+1);
+  prj->remove_empty_records();
+
+  CCCC_Record::set_active_project(prj);
+  ParseFilesInProcess();
+  CCCC_Record::set_active_project(NULL);
+
+  if(incremental)
+    {
+      for(changeIter=changed.begin(); changeIter!=changed.end(); ++changeIter)
+	{
+	  const file_entry& entry=watched_files[*changeIter];
+	  string hash=FileHash(entry);
+	  if(hash.size()>0)
+	    {
+	      prj->file_hash_table[entry.first]=hash;
+	    }
+	}
+    }
+
+  if(serve_socket!="")
+    {
+      prj->reindex(jobs);
+    }
+  else
+    {
+      SaveResults();
+    }
+
+  cerr << "Results brought up to date in "
+       << std::chrono::duration_cast<std::chrono::milliseconds>(
+	    std::chrono::steady_clock::now()-start_time).count()
+       << " ms" << endl;
+}
+
+/*
+** method to handle a request to analyze some files, which may be new
+*/
+bool Main::Analyze(CCCC_Item& request, string& message)
+{
+  // The files already in the list are found by name, and any others 
+  // are added to the end of it, once all have been checked.
+  std::map<string,size_t> file_indices;
+  for(size_t i=0; i<watched_files.size(); i++)
+    {
+      file_indices.insert(std::make_pair(watched_files[i].first,i));
+    }
+
+  std::set<size_t> changed;
+  std::vector<string> new_files;
+  string filename;
+  while(request.Extract(filename))
+    {
+      if(filename=="")
+	{
+	  continue;
+	}
+      std::map<string,size_t>::iterator indexIter=file_indices.find(filename);
+      if(indexIter!=file_indices.end())
+	{
+	  changed.insert((*indexIter).second);
+	}
+      else if(access(filename.c_str(),R_OK)!=0)
+	{
+	  message="can't read "+filename;
+	  return false;
+	}
+      else
+	{
+	  file_indices.insert(std::make_pair(filename,watched_files.size()+
+					     new_files.size()));
+	  new_files.push_back(filename);
+	}
+    }
+  if(changed.empty() && new_files.empty())
+    {
+      message="no files named";
+      return false;
+    }
+
+  for(size_t i=0; i<new_files.size(); i++)
+    {
+      changed.insert(watched_files.size());
+      watched_files.push_back(file_entry(new_files[i],lang));
+    }
+  UpdateFiles(changed);
+  return true;
+}
+
+/*
+** method to handle a single request made of a server, returning false
+** if the server is to shut down
+*/
+bool Main::HandleRequest(const string& request_line, std::ostream& reply)
+{
+  bool retval=true;
+
+  // the last field need not be terminated
+  CCCC_Item request(request_line);
+  if(request_line.size()>0 && request_line[request_line.size()-1]!='@')
+    {
+      request=CCCC_Item(request_line+"@");
+    }
+  string query;
+  request.Extract(query);
+
+  if(query=="shutdown")
+    {
+      reply << "OK@\n\n";
+      retval=false;
+    }
+  else if(query=="analyze")
+    {
+      int parsed_before=files_parsed;
+      string message;
+      if(Analyze(request,message))
+	{
+	  CCCC_Item files_line;
+	  files_line.Insert("files");
+	  files_line.Insert(files_parsed-parsed_before);
+	  files_line.Insert(int(watched_files.size()));
+	  reply << "OK@\n" << files_line.Text() << "\n\n";
+	}
+      else
+	{
+	  CCCC_Query::Error(message,reply);
+	}
+    }
+  else if(!CCCC_Query::Answer(prj,query,request,reply))
+    {
+      CCCC_Query::Error("unknown request "+query,reply);
+    }
+  return retval;
+}
+
+/*
+** method to answer requests made on a local socket, until asked to 
+** shut down
+*/
+void Main::Serve()
+{
+#ifndef _WIN32
+  // A client which goes away before its answer has been written should
+  // not take the server with it.
+  signal(SIGPIPE,SIG_IGN);
+
+  struct sockaddr_un address;
+  memset(&address,0,sizeof(address));
+  address.sun_family=AF_UNIX;
+  if(serve_socket.size()>=sizeof(address.sun_path))
+    {
+      cerr << "Socket name " << serve_socket << " is too long" << endl;
+      return;
+    }
+  strcpy(address.sun_path,serve_socket.c_str());
+
+  // a socket left behind by an earlier server is replaced
+  struct stat socket_stat;
+  if(stat(serve_socket.c_str(),&socket_stat)==0 && 
+     S_ISSOCK(socket_stat.st_mode))
+    {
+      unlink(serve_socket.c_str());
+    }
+
+  int listen_fd=socket(AF_UNIX,SOCK_STREAM,0);
+  if(listen_fd<0 ||
+     bind(listen_fd,(struct sockaddr*)&address,sizeof(address))!=0 ||
+     listen(listen_fd,16)!=0)
+    {
+      cerr << "Couldn't serve requests on " << serve_socket << endl;
+      if(listen_fd>=0)
+	{
+	  close(listen_fd);
+	}
+      return;
+    }
+  fcntl(listen_fd,F_SETFD,FD_CLOEXEC);
+
+  cerr << "Serving requests on " << serve_socket << endl;
+
+  // Each client may make any number of requests, one line each, which
+  // are answered in turn.  The server itself does one thing at a time.
+  struct Client
+  {
+    int fd;
+    string input;
+  };
+  std::vector<Client> clients;
+  bool running=true;
+  while(running)
+    {
+      std::vector<struct pollfd> poll_fds(clients.size()+1);
+      poll_fds[0].fd=listen_fd;
+      poll_fds[0].events=POLLIN;
+      poll_fds[0].revents=0;
+      for(size_t i=0; i<clients.size(); i++)
+	{
+	  poll_fds[i+1].fd=clients[i].fd;
+	  poll_fds[i+1].events=POLLIN;
+	  poll_fds[i+1].revents=0;
+	}
+      int ready=poll(&poll_fds[0],poll_fds.size(),-1);
+      if(ready<0)
+	{
+	  if(errno==EINTR)
+	    {
+	      continue;
+	    }
+	  break;
+	}
+
+      std::vector<Client> remaining_clients;
+      for(size_t i=0; i<clients.size(); i++)
+	{
+	  Client& client=clients[i];
+	  bool open=true;
+	  if(running && poll_fds[i+1].revents!=0)
+	    {
+	      char buffer[65536];
+	      ssize_t length=read(client.fd,buffer,sizeof(buffer));
+	      if(length<=0)
+		{
+		  open=false;
+		}
+	      else
+		{
+		  client.input.append(buffer,length);
+		}
+
+	      size_t newline_pos;
+	      while(open && running && 
+		    (newline_pos=client.input.find('\n'))!=string::npos)
+		{
+		  string request_line=client.input.substr(0,newline_pos);
+		  client.input.erase(0,newline_pos+1);
+		  if(request_line.size()>0 && 
+		     request_line[request_line.size()-1]=='\r')
+		    {
+		      request_line.erase(request_line.size()-1);
+		    }
+
+		  ostringstream reply;
+		  running=HandleRequest(request_line,reply);
+		  string reply_text=reply.str();
+		  size_t written=0;
+		  while(open && written<reply_text.size())
+		    {
+		      ssize_t count=write(client.fd,reply_text.data()+written,
+					  reply_text.size()-written);
+		      if(count>0)
+			{
+			  written+=count;
+			}
+		      else if(count<0 && errno==EINTR)
+			{
+			  continue;
+			}
+		      else
+			{
+			  open=false;
+			}
+		    }
+		}
+	    }
+	  if(open && running)
+	    {
+	      remaining_clients.push_back(client);
+	    }
+	  else
+	    {
+	      close(client.fd);
+	    }
+	}
+      clients.swap(remaining_clients);
+
+      if(running && (poll_fds[0].revents & POLLIN))
+	{
+	  Client client;
+	  client.fd=accept(listen_fd,NULL,NULL);
+	  if(client.fd>=0)
+	    {
+	      fcntl(client.fd,F_SETFD,FD_CLOEXEC);
+	      clients.push_back(client);
+	    }
+	}
+    }
+
+  for(size_t i=0; i<clients.size(); i++)
+    {
+      close(clients[i].fd);
+    }
+  close(listen_fd);
+  unlink(serve_socket.c_str());
+  cerr << "Stopped serving requests" << endl;
+#else
+  cerr << "Serving requests is not supported on this platform" << endl;
+#endif
+}
+
+void Main::GenerateReports()
+{
+  // The separate module reports are only written if their content has
+  // changed since the last run, which the manifest keeps track of.
+  CCCC_PageManifest manifest(outdir);
+
+  // The HTML and XML reports only read the database, so with more than
+  // one job they are written side by side, each sharing the jobs out 
+  // among its separate module reports.
+  if(jobs>1)
+    {
+      cerr << endl << "Generating HTML and XML reports" << endl;
+      std::thread xml_thread(&Main::GenerateXml,this,&manifest);
+      GenerateHtml(&manifest);
+      xml_thread.join();
+    }
+  else
+    {
+      cerr << endl << "Generating HTML reports" << endl;
+      GenerateHtml(&manifest);
+      cerr << endl << "Generating XML reports" << endl;
+      GenerateXml(&manifest);
+    }
+  manifest.Save();
+}
+
+void Main::GenerateHtml(CCCC_PageManifest *manifest)
+{
+  CCCC_Html_Stream::GenerateReports(prj,report_mask,html_outfile,outdir,
+				    jobs,manifest);
+
+}
+
+void Main::GenerateXml(CCCC_PageManifest *manifest)
+{
+  CCCC_Xml_Stream::GenerateReports(prj,report_mask,xml_outfile,outdir,
+				   jobs,manifest);
+
+}
+
+void Main::HandleDebugOption(const string& arg) 
+{
   /*
   ** arg may either be a number, or a string of letters denoting
   ** facilities to be debugged.  
@@ -641,7 +2912,13 @@ void Main::PrintCredits(ostream& os)
 
 void Main::DescribeOutput()
 {
-  if(files_parsed>0)
+  if(shard_count>0)
+  {
+      cerr << endl 
+           << "Database fragment for shard " << shard_index << "/" 
+           << shard_count << " is in " << db_outfile << endl << endl;
+  }
+  else if(resultsAvailable())
   {
       // make sure the user knows where the real output went
       // make sure the user knows where the real output went
@@ -656,7 +2933,11 @@ void Main::DescribeOutput()
       { 
          cerr << "Detailed XML reports on modules are in " << outdir << endl;
       }
-      cerr << "Database dump is in " << db_outfile << endl << endl;
+      if(!report_only)
+      {
+         cerr << "Database dump is in " << db_outfile << endl;
+      }
+      cerr << endl;
   }
   else
   {
@@ -688,6 +2969,70 @@ void Main::PrintUsage(ostream& os)
     "--opt_outfile=<fname>    * save options to named file {<outdir>/cccc.opt}",
     "--lang=<string>          * use language specified for files specified ",
     "                           after this option (c,c++,ada,java, no default)",
+    "--jobs=<n>               * parse up to n files at once on separate threads,",
+    "                           index the results and write reports on as many",
+    "                           (results are identical to a serial run) {1}",
+    "--shard=<i>/<n>          * parse only the files in shard i (counting from 0)",
+    "                           of n, chosen by a hash of each path, and save the",
+    "                           unindexed database fragment without reports",
+    "--merge                  * treat the files named as database fragments from",
+    "                           --shard runs, and merge them to generate reports",
+    "--report_only            * treat the files named as databases saved by",
+    "                           earlier runs {<db_outfile>}, and generate the",
+    "                           reports from them under the current options,",
+    "                           without reading any source file (the source",
+    "                           listing is left as it was)",
+    "--workers=<n>            * divide the files between n child processes, each",
+    "                           of which may use --jobs threads, and merge their",
+    "                           results (identical to a serial run) {1}",
+    "                           When --jobs or --workers is used, the parse time",
+    "                           of each file is saved in the database, and is",
+    "                           used by the next run to start the slowest first.",
+    "--prefetch=<n>           * read up to n files ahead of the parser on a",
+    "                           background thread, 0 to disable {4}",
+    "--prefetch_memory=<mb>   * limit the memory used by files read ahead {64}",
+    "--pipeline               * run the lexer for each file ahead of the parser",
+    "                           on a thread of its own",
+    "--dedup=<mode>           * parse only the first of the files with the same",
+    "                           content and language; with mode path, pass its",
+    "                           records on again for each copy, under the copy's",
+    "                           name (the results are identical to parsing every",
+    "                           copy), and with mode once, leave the copies out,",
+    "                           so that the content is counted once",
+    "--cache_dir=<dir>        * keep the records found in each file in a cache",
+    "                           directory, which may be shared, and take them",
+    "                           from there for any file with the same content,",
+    "                           language and dialect options",
+    "--git_rev=<tree-ish>     * read the files from the named revision of the",
+    "                           git repository holding the current directory,",
+    "                           without checking it out; if no files are named,",
+    "                           analyze all files in the revision below the",
+    "                           current directory with a known extension",
+    "--baseline_db=<fname>    * with --changed_from, load a database saved by an",
+    "--changed_from=<rev>       earlier run at the given revision, and parse",
+    "                           only the files which git reports as changed",
+    "                           since (up to --git_rev if given), or which the",
+    "                           database does not cover; if no files are named,",
+    "                           those in the database, less any deleted since,",
+    "                           and any added since with a known extension,",
+    "                           in order of their paths",
+    "--watch                  * after the first run, watch the files named for",
+    "                           changes, and bring the results up to date each",
+    "                           time any of them changes, until interrupted",
+    "--serve=<socket>         * after the first run, keep the results and answer",
+    "                           requests made on the named local socket, one",
+    "                           line each, without writing any reports:",
+    "                           analyze@<file>@...@ to parse files again or add",
+    "                           them, modules@, module@<name>@, member@<name>@",
+    "                           to get metrics, and shutdown@ (see cccc_qry.h)",
+    "--incremental            * load the database saved by the previous run,",
+    "                           and parse only the files whose content has",
+    "                           changed since (the database is then saved",
+    "                           unindexed, so that the next run can reuse it)",
+    "--split_lines=<n>        * split C/C++ files of 2n lines or more into",
+    "                           fragments of about n lines at top level",
+    "                           declarations, and parse them on --jobs threads",
+    "                           (results are identical to an unsplit parse) {0}",
     "--report_mask=<hex>      * control report content ",
     "--debug_mask=<hex>       * control debug output content ",
     "                           (refer to ccccmain.cc for mask values)",
@@ -709,6 +3054,11 @@ int Main::filesParsed()
   return files_parsed;
 }
 
+bool Main::resultsAvailable()
+{
+  return files_parsed>0 || databases_merged>0 || files_reused>0;
+}
+
 int main(int argc, char **argv)
 {
   app=new Main;
@@ -720,27 +3070,73 @@ int main(int argc, char **argv)
   // If we are still running, acknowledge those who helped
   app->PrintCredits(cerr);
 
-  cerr << "Parsing" << endl;
-  CCCC_Record::set_active_project(prj);
-  app->ParseFiles();
-  CCCC_Record::set_active_project(NULL);
+  if(app->merge_mode)
+  {
+      cerr << "Merging" << endl;
+      app->MergeDatabases();
+  }
+  else if(app->report_only)
+  {
+      app->MergeDatabases();
+  }
+  else
+  {
+      app->LoadDatabase();
+      if(app->shard_count>0)
+      {
+	  app->SelectShard();
+      }
+      if(app->incremental)
+      {
+	  app->SelectChangedFiles();
+      }
+      if(app->baseline_db!="")
+      {
+	  app->SelectDeltaFiles();
+      }
+      if(app->dedup_mode!="")
+      {
+	  app->SelectDistinctFiles();
+      }
+      cerr << "Parsing" << endl;
+      CCCC_Record::set_active_project(prj);
+      app->ParseFiles();
+      app->CopyDuplicateRecords();
+      CCCC_Record::set_active_project(NULL);
+  }
 
-  if(app->filesParsed()>0)
+  if(app->shard_count>0)
   {
-      prj->reindex();
-#ifdef _WIN32
-      _mkdir(app->outdir.c_str());
-#else
-      mkdir(app->outdir.c_str(),0777);
-#endif
+      // The fragment is saved before reindexing, as relationships can
+      // only be resolved once the fragments from all shards are merged.
+      app->MakeOutputDirectory();
       app->DumpDatabase();
+  }
+  else if(app->serve_socket!="")
+  {
+      // A server answers from the project held in memory, so it has no
+      // need of the database or the reports.
+      prj->reindex(app->jobs);
+  }
+  else if(app->resultsAvailable())
+  {
+      app->SaveResults();
+  }
 
-      // generate html output
-      app->GenerateHtml();
-      app->GenerateXml();
+  if(app->serve_socket!="")
+  {
+      app->Serve();
+  }
+  else
+  {
+      app->DescribeOutput();
   }
 
-  app->DescribeOutput();
+  if(app->watch)
+  {
+      app->Watch();
+  }
+  CCCC_GitSource::Install(NULL);
   delete app;
   delete prj;
 
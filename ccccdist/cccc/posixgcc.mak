@@ -12,6 +12,9 @@
 ## encountered on GCC 3.2 - as we don't prebuild binaries at present
 ## dynamic linking shouldn't be a killer problem.
 
+## Parsing on several threads at once (--jobs) needs the compiler and 
+## linker to be told that the program is multithreaded.
+
 ## (More reports welcome)
 ## See rules.mak for discussion of the meaning of the make variables
 ## which this file defines
@@ -26,9 +29,9 @@ PATHSEP=/
 
 CCC=g++
 LD=g++
-CFLAGS=-c -I../pccts/h $(CFLAGS_DEBUG) -x c++ 
+CFLAGS=-c -I../pccts/h $(CFLAGS_DEBUG) -pthread -x c++ 
 C_OFLAG=-o
-LDFLAGS=$(LDFLAGS_DEBUG)
+LDFLAGS=$(LDFLAGS_DEBUG) -pthread
 LD_OFLAG=-o
 OBJEXT=o
 CCCC_EXE=cccc
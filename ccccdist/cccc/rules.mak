@@ -82,11 +82,13 @@ USR_G = cccc.g java.g ada.g
 USR_C = ccccmain.cc cccc_tok.cc cccc_met.cc cccc_utl.cc \
 		cccc_db.cc cccc_rec.cc cccc_ext.cc cccc_prj.cc cccc_mod.cc \
 		cccc_mem.cc cccc_use.cc cccc_htm.cc cccc_xml.cc cccc_tbl.cc \
-		cccc_tpl.cc cccc_new.cc cccc_itm.cc cccc_opt.cc
+		cccc_tpl.cc cccc_new.cc cccc_itm.cc cccc_opt.cc cccc_src.cc \
+		cccc_cch.cc cccc_qry.cc cccc_sym.cc
 
 USR_H = cccc.h cccc_tok.h cccc_met.h cccc_utl.h \
 		cccc_db.h cccc_htm.h cccc_tbl.h cccc_itm.h \
-		cccc_opt.h
+		cccc_opt.h cccc_src.h cccc_cch.h cccc_qry.h \
+		cccc_mdf.h cccc_sym.h
 
 ## documentation
 USR_DOC =       readme.txt cccc_ug.htm
@@ -124,6 +126,8 @@ USR_OBJ = \
 	cccc_use.$(OBJEXT) cccc_met.$(OBJEXT) cccc_htm.$(OBJEXT) cccc_xml.$(OBJEXT) \
 	cccc_tok.$(OBJEXT) cccc_tbl.$(OBJEXT) \
 	cccc_tpl.$(OBJEXT) cccc_new.$(OBJEXT) cccc_itm.$(OBJEXT) \
+	cccc_src.$(OBJEXT) cccc_cch.$(OBJEXT) cccc_qry.$(OBJEXT) \
+	cccc_sym.$(OBJEXT) \
 
 
 ALL_OBJ = $(SPAWN_OBJ) $(USR_OBJ) $(PCCTS_OBJ)
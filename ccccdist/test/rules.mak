@@ -24,7 +24,7 @@
 # of 'blessing' the results of a run as the reference values
 .SUFFIXES : .do_the_test .cc .c .java
 
-all : unit_tests regression_tests
+all : unit_tests regression_tests parallel_tests
 	@$(ECHO) ================
 	@$(ECHO) All tests passed
 	@$(ECHO) ================
@@ -98,3 +98,117 @@ regression_tests : \
 	prn13.do_the_test prn14.do_the_test prn15.do_the_test \
 	prn16.do_the_test
 
+
+# The parallel tests check that the options which spread the work of a
+# run across several threads or processes give exactly the same results
+# as a serial run over the same files.  Parallel runs also save the 
+# time taken to parse each file, which varies from run to run, so those
+# lines are stripped from their databases before comparison.  The second
+# run of each pair reads the times saved by the first, and so is scheduled
+# differently.
+PARALLEL_TEST_FILES=test1.cc test2.cc test3.cc prn1.cc prn2.cc prn3.cc \
+	prn4.cc prn5.cc prn6.cc prn9.cc prn10.cc prn11.cc prn12.cc
+
+parallel_tests : jobs.do_the_test workers.do_the_test merge.do_the_test \
+	split.do_the_test pipeline.do_the_test incremental.do_the_test \
+	cache.do_the_test report.do_the_test dedup.do_the_test
+
+jobs.do_the_test :
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --jobs=4 --report_mask=cspPrRojh --db_outfile=jobs.db --html_outfile=jobs.html --xml_outfile=jobs.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --jobs=4 --report_mask=cspPrRojh --db_outfile=jobs.db --html_outfile=jobs.html --xml_outfile=jobs.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	grep -v "^CCCC_FileCost@" jobs.db > jobs.nocost.db
+	$(DIFF) jobs.nocost.db serial.db
+	$(DIFF) jobs.html serial.html
+	$(DIFF) jobs.xml serial.xml
+
+workers.do_the_test :
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --workers=3 --report_mask=cspPrRojh --db_outfile=workers.db --html_outfile=workers.html --xml_outfile=workers.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --workers=3 --report_mask=cspPrRojh --db_outfile=workers.db --html_outfile=workers.html --xml_outfile=workers.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	grep -v "^CCCC_FileCost@" workers.db > workers.nocost.db
+	$(DIFF) workers.nocost.db serial.db
+	$(DIFF) workers.html serial.html
+	$(DIFF) workers.xml serial.xml
+
+# Splitting every file at each possible point exercises the stitching of
+# fragments back together as thoroughly as these files allow.
+split.do_the_test :
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --split_lines=1 --jobs=2 --report_mask=cspPrRojh --db_outfile=split.db --html_outfile=split.html --xml_outfile=split.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	grep -v "^CCCC_FileCost@" split.db > split.nocost.db
+	$(DIFF) split.nocost.db serial.db
+	$(DIFF) split.html serial.html
+	$(DIFF) split.xml serial.xml
+
+pipeline.do_the_test :
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --pipeline --report_mask=cspPrRojh --db_outfile=pipeline.db --html_outfile=pipeline.html --xml_outfile=pipeline.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(DIFF) pipeline.db serial.db
+	$(DIFF) pipeline.html serial.html
+	$(DIFF) pipeline.xml serial.xml
+
+# A single shard holds every file in the original order, so merging its
+# fragment on its own must reproduce the serial run exactly.
+merge.do_the_test :
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --shard=0/1 --db_outfile=shard.db $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --merge --report_mask=cspPrRojh --db_outfile=merge.db --html_outfile=merge.html --xml_outfile=merge.xml $(CCCC_DEBUG_FLAGS) shard.db
+	$(DIFF) merge.db serial.db
+	$(DIFF) merge.html serial.html
+	$(DIFF) merge.xml serial.xml
+
+# A copy of one file is added to the list after the original, and its
+# records are copied from those of the original on two threads.
+dedup.do_the_test :
+	$(CP) prn1.cc copied.cc
+	$(CCCC) --dedup=path --jobs=2 --report_mask=cspPrRojh --db_outfile=dedup.db --html_outfile=dedup.html --xml_outfile=dedup.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES) copied.cc
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES) copied.cc
+	grep -v "^CCCC_FileCost@" dedup.db > dedup.nocost.db
+	$(DIFF) dedup.nocost.db serial.db
+	$(DIFF) dedup.html serial.html
+	$(DIFF) dedup.xml serial.xml
+
+# Reports generated from the database of a serial run must match the
+# reports of that run.
+report.do_the_test :
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CCCC) --report_only --report_mask=cspPrRojh --html_outfile=report.html --xml_outfile=report.xml $(CCCC_DEBUG_FLAGS) serial.db
+	$(DIFF) report.html serial.html
+	$(DIFF) report.xml serial.xml
+
+# The incremental test brings a database up to date after one file has
+# changed (and shares its module names with an unchanged one), one has
+# gone and the rest are as they were.  The result must match both a 
+# serial run and an incremental run starting from scratch.
+INCREMENTAL_TEST_FILES=incremental.cc test1.cc test3.cc prn1.cc prn2.cc \
+	prn3.cc prn4.cc prn5.cc prn6.cc prn9.cc prn10.cc prn11.cc prn12.cc
+
+incremental.do_the_test :
+	$(CP) test3.cc incremental.cc
+	$(RMDIR) incremental.db
+	$(CCCC) --incremental --report_mask=cspPrRojh --db_outfile=incremental.db --html_outfile=incremental.html --xml_outfile=incremental.xml $(CCCC_DEBUG_FLAGS) incremental.cc $(PARALLEL_TEST_FILES)
+	$(CP) prn5.cc incremental.cc
+	$(CCCC) --incremental --jobs=3 --report_mask=cspPrRojh --db_outfile=incremental.db --html_outfile=incremental.html --xml_outfile=incremental.xml $(CCCC_DEBUG_FLAGS) $(INCREMENTAL_TEST_FILES)
+	$(RMDIR) scratch.db
+	$(CCCC) --incremental --report_mask=cspPrRojh --db_outfile=scratch.db --html_outfile=scratch.html --xml_outfile=scratch.xml $(CCCC_DEBUG_FLAGS) $(INCREMENTAL_TEST_FILES)
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(INCREMENTAL_TEST_FILES)
+	grep -v "^CCCC_FileCost@" incremental.db > incremental.nocost.db
+	$(DIFF) incremental.nocost.db scratch.db
+	$(DIFF) incremental.html scratch.html
+	$(DIFF) incremental.xml scratch.xml
+	$(DIFF) incremental.html serial.html
+	$(DIFF) incremental.xml serial.xml
+
+# The second cache test run takes the records for every file from the
+# cache filled by the first, including those for a copy of one of the
+# files under another name.
+cache.do_the_test :
+	$(RMDIR) cache
+	$(CCCC) --cache_dir=cache --jobs=2 --report_mask=cspPrRojh --db_outfile=cache.db --html_outfile=cache.html --xml_outfile=cache.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES)
+	$(CP) test2.cc cached.cc
+	$(CCCC) --cache_dir=cache --report_mask=cspPrRojh --db_outfile=cache.db --html_outfile=cache.html --xml_outfile=cache.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES) cached.cc
+	$(CCCC) --report_mask=cspPrRojh --db_outfile=serial.db --html_outfile=serial.html --xml_outfile=serial.xml $(CCCC_DEBUG_FLAGS) $(PARALLEL_TEST_FILES) cached.cc
+	$(DIFF) cache.db serial.db
+	$(DIFF) cache.html serial.html
+	$(DIFF) cache.xml serial.xml